@@ -0,0 +1,274 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: Benchmark.cpp
+
+Description: Micro-benchmarks of the paths the program spends its time in: the four affine
+transformations (appending the matrix and evaluating the vertices, as the apply functions do),
+building the shape geometry, parsing vertex text and printing the vertices, and the vertex kernel
+alone for each scalar type the program can be built with. Each benchmark runs
+for vertex counts from 10 to 10^7 and reports the time per vertex, the throughput and the number
+of heap allocations per run, counted by replacing the global operator new.
+
+Usage: AffineT.Bench [--max-count n] [--min-time milliseconds] [--filter name]
+
+-----------------------------------------------------------------------------------------------*/
+
+#include "RotationCache.h"
+#include "TransformKernel.h"
+#include "ShapeScene.h"
+#include "TransformPipeline.h"
+#include "VertexFile.h"
+#include "VertexPrinter.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+using namespace std;
+
+//initializing the counter of heap allocations, incremented by the replaced operator new
+atomic<size_t> allocation_count(0);
+
+void* operator new(size_t size)
+{
+    ++allocation_count;
+    if (void* memory = malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+// Benchmark options
+struct Options
+{
+    size_t maxCount = 10000000;
+    double minTime = 200; // Milliseconds each benchmark runs for at every vertex count
+    string filter;
+};
+
+// A benchmark prepares its data for a vertex count once and returns the function measured
+typedef function<function<void()>(size_t count)> Benchmark;
+
+struct BenchmarkCase
+{
+    string name;
+    size_t maxCount; // Larger counts are skipped, the geometry of the shapes does not fit in memory beyond it
+    Benchmark setup;
+};
+
+// Function to create count vertices spread on a circle, like a detailed input shape
+VertexStore createVertices(size_t count)
+{
+    VertexStore vertices(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        double angle = 6.283185307179586 * i / count;
+        vertices.x()[i] = static_cast<float>(3 * cos(angle));
+        vertices.y()[i] = static_cast<float>(2 * sin(angle));
+    }
+    return vertices;
+}
+
+// Function to create a benchmark of one transformation: the matrix is appended and the vertices
+// evaluated, which is what the program does for each command it reads
+BenchmarkCase transformCase(const string& name, const TransformCommand& command)
+{
+    Benchmark setup = [command](size_t count) {
+        auto pipeline = make_shared<TransformPipeline>(createVertices(count));
+        return function<void()>([pipeline, command]() {
+            // Every run transforms the original vertices, so the journal does not grow and the matrix does
+            // not compound over the runs
+            pipeline->jumpTo(0);
+            pipeline->append(command);
+            pipeline->vertices();
+        });
+    };
+    return BenchmarkCase{ name, ~size_t(0), setup };
+}
+
+// Function to create a benchmark of the vertex kernel with the coefficients of a rotation in the scalar type T
+template <typename T>
+BenchmarkCase kernelCase(const string& name)
+{
+    Benchmark setup = [](size_t count) {
+        auto vertices = make_shared<VertexStore>(createVertices(count));
+        auto transformed = make_shared<VertexStore>(count);
+        BasicAffineMatrix<T> matrix = rotationMatrix(1.5).cast<T>();
+        return function<void()>([vertices, transformed, matrix]() {
+            transformVertices(matrix, vertices->x(), vertices->y(), transformed->x(), transformed->y(), vertices->size());
+        });
+    };
+    return BenchmarkCase{ name, ~size_t(0), setup };
+}
+
+vector<BenchmarkCase> createBenchmarks()
+{
+    vector<BenchmarkCase> benchmarks;
+    benchmarks.push_back(transformCase("translate", TransformCommand{ TransformType::Translation, 0.5f, -0.25f }));
+    benchmarks.push_back(transformCase("scale", TransformCommand{ TransformType::Scaling, 1.001f, 0.999f }));
+    benchmarks.push_back(transformCase("rotate", TransformCommand{ TransformType::Rotation, 1.5f, 0 }));
+    benchmarks.push_back(transformCase("shear", TransformCommand{ TransformType::Shearing, 0.001f, -0.001f }));
+    benchmarks.push_back(kernelCase<float>("kernel float"));
+    benchmarks.push_back(kernelCase<double>("kernel double"));
+    benchmarks.push_back(kernelCase<Fixed32>("kernel fixed"));
+
+    // Building the geometry of a new shape, fill and outline, as the program does for each shape it shows
+    benchmarks.push_back(BenchmarkCase{ "shape", 1000000, [](size_t count) {
+        auto vertices = make_shared<VertexStore>(createVertices(count));
+        return function<void()>([vertices]() {
+            ShapeScene scene;
+            scene.addShape(*vertices, sf::Color::Red, sf::Color::White, 0.02f);
+        });
+    } });
+
+    // Moving the points of an existing shape, done after every transformation
+    benchmarks.push_back(BenchmarkCase{ "shape update", 1000000, [](size_t count) {
+        auto vertices = make_shared<VertexStore>(createVertices(count));
+        auto scene = make_shared<ShapeScene>();
+        scene->addShape(*vertices, sf::Color::Red, sf::Color::White, 0.02f);
+        return function<void()>([vertices, scene]() {
+            scene->updateShape(0, *vertices);
+        });
+    } });
+
+    // Parsing vertex text, one "x y" pair per line like the vertex files and the console input
+    benchmarks.push_back(BenchmarkCase{ "parse", ~size_t(0), [](size_t count) {
+        VertexStore vertices = createVertices(count);
+        auto text = make_shared<vector<char>>(count * maxVertexLineLength);
+        char* end = text->data();
+        for (size_t i = 0; i < count; ++i)
+        {
+            end = formatVertexLine(end, vertices.x()[i], vertices.y()[i]);
+        }
+        text->resize(end - text->data());
+        auto parsed = make_shared<VertexStore>(count);
+        return function<void()>([text, parsed]() {
+            const char* line = text->data();
+            const char* end = line + text->size();
+            size_t index = 0;
+            while (line < end)
+            {
+                const char* next = line;
+                while (next < end && *next != '\n')
+                    ++next;
+                bool isVertex;
+                float x, y;
+                if (parseVertexLine(line, next, x, y, isVertex) && isVertex)
+                {
+                    parsed->x()[index] = x;
+                    parsed->y()[index] = y;
+                    ++index;
+                }
+                line = next + 1;
+            }
+        });
+    } });
+
+    // Printing all the vertices, written to the null device so the console speed is not measured
+    benchmarks.push_back(BenchmarkCase{ "print", ~size_t(0), [](size_t count) {
+#ifdef _WIN32
+        FILE* nullDevice = fopen("NUL", "w");
+#else
+        FILE* nullDevice = fopen("/dev/null", "w");
+#endif
+        auto vertices = make_shared<VertexStore>(createVertices(count));
+        auto printer = make_shared<VertexPrinter>(Verbosity::Full, nullDevice ? nullDevice : stdout);
+        shared_ptr<FILE> output(nullDevice, [](FILE* file) { if (file) fclose(file); });
+        return function<void()>([vertices, printer, output]() {
+            printer->print(*vertices);
+        });
+    } });
+    return benchmarks;
+}
+
+// Function to read the command line options
+bool parseArguments(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string argument = argv[i];
+        if (argument == "--max-count" && i + 1 < argc)
+        {
+            options.maxCount = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--min-time" && i + 1 < argc)
+        {
+            options.minTime = atof(argv[++i]);
+        }
+        else if (argument == "--filter" && i + 1 < argc)
+        {
+            options.filter = argv[++i];
+        }
+        else
+        {
+            cout << "Usage: AffineT.Bench [--max-count n] [--min-time milliseconds] [--filter name]" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Function to run a benchmark for a vertex count and print its line of the report
+// The function is run once to warm up, then repeated until the minimum time is reached
+void runBenchmark(const BenchmarkCase& benchmark, size_t count, double minTime)
+{
+    function<void()> run = benchmark.setup(count);
+    run();
+
+    size_t runs = 0;
+    size_t allocations = allocation_count.load();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    double elapsed = 0;
+    do
+    {
+        run();
+        ++runs;
+        elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    } while (elapsed < minTime);
+    allocations = allocation_count.load() - allocations;
+
+    double nsPerVertex = elapsed * 1e6 / (static_cast<double>(runs) * count);
+    printf("%-14s %10zu %12.3f %14.2f %12.1f\n", benchmark.name.c_str(), count, nsPerVertex,
+           1e3 / nsPerVertex, static_cast<double>(allocations) / runs);
+}
+
+// Main function
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseArguments(argc, argv, options))
+    {
+        return 1;
+    }
+
+    printf("Vertices transformed in %s\n", scalarName);
+    printf("%-14s %10s %12s %14s %12s\n", "benchmark", "vertices", "ns/vertex", "Mvertices/s", "allocs/run");
+    for (const BenchmarkCase& benchmark : createBenchmarks())
+    {
+        if (!options.filter.empty() && benchmark.name.find(options.filter) == string::npos)
+        {
+            continue;
+        }
+        for (size_t count = 10; count <= options.maxCount && count <= benchmark.maxCount; count *= 10)
+        {
+            runBenchmark(benchmark, count, options.minTime);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: AffineMatrix.h
+
+Description: 3x3 homogeneous matrix used to compose affine transformations. Operations are
+appended to a single matrix so the vertices of a shape only have to be evaluated once.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "Scalar.h"
+#include <SFML/System/Vector2.hpp>
+#include <cmath>
+
+// The bottom row of an affine matrix is always (0, 0, 1), so only the top two rows are stored
+//  | a  b  tx |
+//  | c  d  ty |
+//  | 0  0  1  |
+// The matrix accumulated over a session is kept in double precision (fixed point in the fixed point build)
+// so long sequences of transformations do not drift, the vertices are transformed with its conversion to
+// the scalar type of the build
+template <typename T>
+struct BasicAffineMatrix
+{
+    T a = 1, b = 0, tx = 0;
+    T c = 0, d = 1, ty = 0;
+
+    // Function to apply the matrix to a single point
+    sf::Vector2<T> apply(const sf::Vector2<T>& point) const
+    {
+        return sf::Vector2<T>(a * point.x + b * point.y + tx, c * point.x + d * point.y + ty);
+    }
+
+    // Function to convert the coefficients to another precision
+    template <typename U>
+    BasicAffineMatrix<U> cast() const
+    {
+        BasicAffineMatrix<U> m;
+        m.a = static_cast<U>(a);
+        m.b = static_cast<U>(b);
+        m.tx = static_cast<U>(tx);
+        m.c = static_cast<U>(c);
+        m.d = static_cast<U>(d);
+        m.ty = static_cast<U>(ty);
+        return m;
+    }
+
+    static BasicAffineMatrix identity()
+    {
+        return BasicAffineMatrix();
+    }
+
+    static BasicAffineMatrix translation(T dx, T dy)
+    {
+        BasicAffineMatrix m;
+        m.tx = dx;
+        m.ty = dy;
+        return m;
+    }
+
+    static BasicAffineMatrix scaling(T sx, T sy)
+    {
+        BasicAffineMatrix m;
+        m.a = sx;
+        m.d = sy;
+        return m;
+    }
+
+    // Counterclockwise rotation around the origin, the angle is in radians
+    static BasicAffineMatrix rotation(T radians)
+    {
+        T cosine = std::cos(radians);
+        T sine = std::sin(radians);
+        BasicAffineMatrix m;
+        m.a = cosine;
+        m.b = -sine;
+        m.c = sine;
+        m.d = cosine;
+        return m;
+    }
+
+    static BasicAffineMatrix shearing(T shx, T shy)
+    {
+        BasicAffineMatrix m;
+        m.b = shx;
+        m.c = shy;
+        return m;
+    }
+};
+
+typedef BasicAffineMatrix<float> AffineMatrix;
+typedef BasicAffineMatrix<double> AffineMatrixD;
+typedef BasicAffineMatrix<Scalar> ScalarMatrix;
+typedef BasicAffineMatrix<JournalScalar> JournalMatrix;
+
+// Matrix product: the result applies rhs first and then lhs
+template <typename T>
+inline BasicAffineMatrix<T> operator*(const BasicAffineMatrix<T>& lhs, const BasicAffineMatrix<T>& rhs)
+{
+    BasicAffineMatrix<T> m;
+    m.a = lhs.a * rhs.a + lhs.b * rhs.c;
+    m.b = lhs.a * rhs.b + lhs.b * rhs.d;
+    m.tx = lhs.a * rhs.tx + lhs.b * rhs.ty + lhs.tx;
+    m.c = lhs.c * rhs.a + lhs.d * rhs.c;
+    m.d = lhs.c * rhs.b + lhs.d * rhs.d;
+    m.ty = lhs.c * rhs.tx + lhs.d * rhs.ty + lhs.ty;
+    return m;
+}
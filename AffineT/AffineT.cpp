@@ -4,7 +4,20 @@ File: AffineT.cpp
 Author: Karam AlHowari
 Date: 2023-012-24
 
-Description: This program visualizes 2d shapes with vertices inputted by the user ranging from 3-10 vertices.
+Description: This program visualizes 2d shapes with vertices inputted by the user or loaded from a file
+with "--vertices file".
+With "--script file" the transformations are read from a command file and applied without opening a window,
+and "--image file" renders the result offscreen to a PNG/PPM image for machines without a display.
+With "--part file", once per shape, the batch mode moves an assembly of several shapes: the commands move all
+of them, or the one selected by a "part n" line of the command file, in the order of the file.
+With "--stream" the vertices are transformed chunk by chunk from a file or the standard input, whatever their size.
+With "--record file" an interactive session is saved to a journal, and "--replay file" executes it again without
+a window, as fast as possible, reporting the time of each action.
+With "--verify" the largest error of the vertices against a long double reference is reported after the transformations.
+With "--profile" the time of each phase of the frames is measured and shown in an overlay toggled with F3, and
+"--profile-csv file" also writes the timings of the last frames to a CSV file when the program ends.
+With "--trace file" the parsing, the transformations, the shape rebuilds and the rendering of every thread are
+written to a Chrome Trace Event JSON file, to be opened in Perfetto, in any mode.
 The user can then apply affine transformations to the shape such as translation, scaling, rotation, and shearing.
 The program uses the SFML library to draw the shapes and the Cartesian coordinate system.
 
@@ -13,130 +26,159 @@ The program uses the SFML library to draw the shapes and the Cartesian coordinat
 
 
 #include <SFML/Graphics.hpp>
+#include "ConsoleInput.h"
+#include "CoordinateGrid.h"
+#include "FrameProfiler.h"
+#include "PrecisionCheck.h"
+#include "ProfilerOverlay.h"
+#include "RotationCache.h"
+#include "SceneGraph.h"
+#include "SessionJournal.h"
+#include "ShapeScene.h"
+#include "TransformPipeline.h"
+#include "TransformScript.h"
+#include "SoftwareRenderTarget.h"
+#include "SpscQueue.h"
+#include "Trace.h"
+#include "VertexFile.h"
+#include "VertexPrinter.h"
+#include "VertexStream.h"
 #include <vector>
 #include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <thread>
 using namespace std;
 
-//initializing global variables scale of the shape, and PI
-int shape_scale = 1;
-const float PI = 3.14159265358979323846;
+//initializing global variable scale of the shape (Cartesian units per 100 pixels)
+float shape_scale = 1;
 
 //initializing global variables for the window size. These could be changed as long as they are divisible by 200
 const int window_width = 800;
 const int window_height = 800;
 
+//initializing the largest number of vertices typed in the console, larger shapes are loaded from a file with --vertices
+const int max_typed_vertices = 100000;
 
-// Function to draw the Cartesian coordinate system
-void drawCoordinateSystem(sf::RenderWindow& window) {
-    sf::VertexArray lines(sf::Lines);
 
-    // Draw vertical lines
-    for (unsigned int x = 0; x <= window_width; x += 100 / shape_scale) {
-        lines.append(sf::Vertex(sf::Vector2f(x, 0), sf::Color(200, 200, 200)));
-        lines.append(sf::Vertex(sf::Vector2f(x, window_height), sf::Color(200, 200, 200)));
-    }
+//initializing the reader of the console input, used by the main thread for the vertices and then by the input thread
+ConsoleInput console_input(stdin);
 
-    // Draw horizontal lines
-    for (unsigned int y = 0; y <= window_height; y += 100 / shape_scale) {
-        lines.append(sf::Vertex(sf::Vector2f(0, y), sf::Color(200, 200, 200)));
-        lines.append(sf::Vertex(sf::Vector2f(window_width, y), sf::Color(200, 200, 200)));
-    }
+//initializing the flag showing the prompts, they are hidden when the commands are piped and read ahead of the render loop
+bool show_prompts = true;
 
-    // Draw x-axis
-    lines.append(sf::Vertex(sf::Vector2f(0, window_height / 2), sf::Color::Blue));
-    lines.append(sf::Vertex(sf::Vector2f(window_width, window_height / 2), sf::Color::Blue));
+//initializing the flag telling main that the input thread was left waiting for the console when the window closed
+bool input_thread_left = false;
 
-    // Draw y-axis
-    lines.append(sf::Vertex(sf::Vector2f(window_width / 2, 0), sf::Color::Blue));
-    lines.append(sf::Vertex(sf::Vector2f(window_width / 2, window_height), sf::Color::Blue));
 
-    window.draw(lines);
+// Function to tell the user why a number was rejected, with its position in the input
+void printInvalidInput(NumberStatus status, int min_value, int max_value)
+{
+    cout << "Invalid input at line " << console_input.line() << ", column " << console_input.column() << ". ";
+    if (status == NumberStatus::Invalid)
+    {
+        cout << "Please enter a valid number." << endl;
+    }
+    else if (status == NumberStatus::OutOfRange)
+    {
+        cout << "Please enter a number within the valid range." << endl;
+    }
+    else
+    {
+        cout << "Please enter a number between " << min_value << " and " << max_value << endl;
+    }
 }
 
-
-// Functions to get correct input from the user
+// Functions to get correct input from the user, they throw runtime_error when the input ends
+// The numbers are parsed without exceptions, an invalid one is reported and the user is asked again
 int getIntegerInput(string message, int min_value, int max_value)
 {
-    string input;
-    int number;
-    bool validInput = false;
-    while (!validInput) {
-        cout << message;
-        cin >> input;
-        try {
-            number = stoi(input);
-            if (number >= min_value && number <= max_value)
-            {
-                validInput = true;
-            }
-            else
-            {
-                cout << "Invalid input. Please enter a number between " << min_value << " and " << max_value << endl;
-            }
+    for (;;)
+    {
+        if (show_prompts)
+        {
+            cout << message << flush;
         }
-        catch (invalid_argument& e) {
-            cout << "Invalid input. Please enter a valid number." << endl;
+        const char* begin;
+        const char* end;
+        if (!console_input.nextToken(begin, end))
+        {
+            throw runtime_error("End of input");
         }
-        catch (out_of_range& e) {
-            cout << "Invalid input. Please enter a number within the valid range." << endl;
+        int number;
+        NumberStatus status;
+        {
+            TraceZone zone("parse input");
+            status = parseNumber(begin, end, number);
         }
+        if (status == NumberStatus::Valid && number >= min_value && number <= max_value)
+        {
+            return number;
+        }
+        printInvalidInput(status, min_value, max_value);
     }
-    return number;
 }
 float getFloatInput(string message, int min_value, int max_value)
 {
-    string input;
-    float number;
-    bool validInput = false;
-    while (!validInput)
+    for (;;)
     {
-        cout << message;
-        cin >> input;
-        try {
-            number = stod(input);
-            if (number > min_value && number < max_value)
-            {
-                validInput = true;
-            }
-            else
-            {
-                cout << "Invalid input. Please enter a number between " << min_value << " and " << max_value << endl;
-            }
+        if (show_prompts)
+        {
+            cout << message << flush;
         }
-        catch (invalid_argument& e) {
-            cout << "Invalid input. Please enter a valid number." << endl;
+        const char* begin;
+        const char* end;
+        if (!console_input.nextToken(begin, end))
+        {
+            throw runtime_error("End of input");
         }
-        catch (out_of_range& e) {
-            cout << "Invalid input. Please enter a number within the valid range." << endl;
+        double value;
+        NumberStatus status;
+        {
+            TraceZone zone("parse input");
+            status = parseNumber(begin, end, value);
         }
+        float number = static_cast<float>(value);
+        if (status == NumberStatus::Valid && number > min_value && number < max_value)
+        {
+            return number;
+        }
+        printInvalidInput(status, min_value, max_value);
     }
-    return number;
 }
 
 
 // Function to get the coordinates of the vertices from the user
-vector<sf::Vector2f> getVertices(size_t numVertices) 
+VertexStore getVertices(size_t numVertices) 
 {
-    vector<sf::Vector2f> vertices(numVertices);
-    float max_value = 0;
+    VertexStore vertices(numVertices);
     for (size_t i = 0; i < numVertices; ++i)
     {
 		// X and Y coordinates of the vertex
         float x, y;
 		x = getFloatInput("Enter x coordinate for vertex " + to_string(i + 1) + ": ", -100, 100);
 		y = getFloatInput("Enter y coordinate for vertex " + to_string(i + 1) + ": ", -100, 100);
-        vertices[i] = sf::Vector2f(x, y);
-		// Find the maximum absolute value of x or y
-        if (abs(x) > max_value)
-        {
-            max_value = abs(x);
-        }
-        if (abs(y) > max_value)
-        {
-            max_value = abs(y);
-        }
+        vertices.x()[i] = x;
+        vertices.y()[i] = y;
+    }
+    return vertices;
+}
+
+// Function to set the shape_scale based on the maximum absolute value of x or y of the vertices
+void setShapeScale(const VertexStore& vertices)
+{
+    float max_value = 0;
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        max_value = max(max_value, max(abs(vertices.x()[i]), abs(vertices.y()[i])));
     }
-	// Set the shape_scale based on the maximum absolute value of x or y
     if (max_value > 2)
     {   
         if (window_width < window_height)
@@ -148,209 +190,928 @@ vector<sf::Vector2f> getVertices(size_t numVertices)
 			shape_scale = max_value / (window_height / 400);
 		}
     }
-    return vertices;
 }
 
-// Function to create a shape for visualization
-sf::ConvexShape createShape(const vector<sf::Vector2f>& vertices)
+// The screen has it's own coordinate system, with the top left corner being (0, 0) and the bottom right corner
+// being (window_width, window_height), so the Cartesian coordinates of the vertices are drawn through this transform
+// to the screen coordinates with (0, 0) being the center of the screen
+sf::Transform screenTransform()
 {
-    sf::ConvexShape shape;
-    shape.setPointCount(vertices.size());
-    for (size_t i = 0; i < vertices.size(); ++i) {
-        shape.setPoint(i, vertices[i]);
-    }
-    shape.setFillColor(sf::Color::Green);
-
-    // Scale and translate the shape to fit within the window
     float scale = 100.0f / shape_scale; // Adjust scale factor based on shape_scale
-    sf::Vector2f offset(window_width/2, window_height/2); // Offset to center the shape in the window
-    for (size_t i = 0; i < vertices.size(); ++i)
+    sf::Transform transform;
+    transform.translate(window_width / 2, window_height / 2); // Offset to center the shape in the window
+    transform.scale(scale, -scale); // Invert y-axis to match Cartesian coordinates
+    return transform;
+}
+
+// Function to get the thickness of the shape outlines, 2 pixels converted to Cartesian units
+float outlineThickness()
+{
+    return 2 * shape_scale / 100.0f;
+}
+
+
+
+
+// Affine transformations: translation, scaling, rotation, and shaering
+// Each function only appends its matrix to the pipeline, the vertices are evaluated when they are needed
+// Function to apply translation to a shape
+void applyTranslation(TransformPipeline& pipeline, float dx, float dy)
+{
+    TraceZone zone("apply translation");
+    pipeline.append(TransformCommand{ TransformType::Translation, dx, dy });
+}
+
+// Function to apply scaling to a shape
+void applyScaling(TransformPipeline& pipeline, float sx, float sy)
+{
+    TraceZone zone("apply scaling");
+    pipeline.append(TransformCommand{ TransformType::Scaling, sx, sy });
+}
+
+// Function to apply rotation to a shape
+// The sine and cosine are computed once for the whole shape, common angles come from the rotation table
+void applyRotation(TransformPipeline& pipeline, float angle)
+{
+    TraceZone zone("apply rotation");
+    pipeline.append(TransformCommand{ TransformType::Rotation, angle, 0 });
+}
+
+// Function to apply shearing to a shape
+void applyShearing(TransformPipeline& pipeline, float shx, float shy)
+{
+    TraceZone zone("apply shearing");
+    pipeline.append(TransformCommand{ TransformType::Shearing, shx, shy });
+}
+
+// Function to apply a transformation command from a script
+void applyCommand(TransformPipeline& pipeline, const TransformCommand& command)
+{
+    switch (command.type)
     {
-        sf::Vector2f point = shape.getPoint(i);
-        point.x = point.x * scale + offset.x;
-        point.y = -point.y * scale + offset.y; // Invert y-axis to match Cartesian coordinates
-        shape.setPoint(i, point);
+    case TransformType::Translation:
+        applyTranslation(pipeline, command.x, command.y);
+        break;
+    case TransformType::Scaling:
+        applyScaling(pipeline, command.x, command.y);
+        break;
+    case TransformType::Rotation:
+        applyRotation(pipeline, command.x);
+        break;
+    case TransformType::Shearing:
+        applyShearing(pipeline, command.x, command.y);
+        break;
     }
+}
 
-    return shape;
+// Function to ask the user for the next action, and for a transformation its type and amount
+void readCommand(InputMessage& message)
+{
+    int transformationType = getIntegerInput("Enter the transformation type (1: translation, 2: scaling, 3: rotation, 4: shearing, 5: exit, 6: undo, 7: redo, 8: go to step): ", 1, 8);
+    TransformCommand& command = message.command;
+    message.action = InputAction::Transform;
+
+    if (transformationType == 5)
+    {
+        message.action = InputAction::Exit;
+    }
+    else if (transformationType == 6)
+    {
+        message.action = InputAction::Undo;
+    }
+    else if (transformationType == 7)
+    {
+        message.action = InputAction::Redo;
+    }
+    else if (transformationType == 8)
+    {
+        message.action = InputAction::JumpTo;
+        message.step = getIntegerInput("Enter the step (0: original shape): ", 0, numeric_limits<int>::max());
+    }
+    else if (transformationType == 1)
+    {
+        command.type = TransformType::Translation;
+        command.x = getFloatInput("Enter translation amount dx: ", -4, 4);
+        command.y = getFloatInput("Enter translation amount dy: ", -4, 4);
+    }
+    else if (transformationType == 2)
+    {
+        command.type = TransformType::Scaling;
+        command.x = getFloatInput("Enter scaling factors (sx): ", 0, 4);
+        command.y = getFloatInput("Enter scaling factors (sy): ", 0, 4);
+    }
+    else if (transformationType == 3)
+    {
+        command.type = TransformType::Rotation;
+        command.x = getFloatInput("Enter rotation angle (degrees): ", -360, 360);
+        command.y = 0;
+    }
+    else
+    {
+        command.type = TransformType::Shearing;
+        command.x = getFloatInput("Enter shearing factors (shx): ", -4, 4);
+        command.y = getFloatInput("Enter shearing factors (shy): ", -4, 4);
+    }
 }
 
+const size_t inputBatchSize = 64;
+typedef SpscQueue<InputMessage, inputBatchSize> InputQueue;
 
+// State shared by the render loop and the input thread. Both own it, so it stays valid for an input thread
+// left waiting for the console after the render loop returned
+struct InputChannel
+{
+    InputQueue queue;
+    atomic<unsigned int> processed;
+    bool lockStep;
 
+    explicit InputChannel(bool lockStep) :
+        processed(0),
+        lockStep(lockStep)
+    {
+    }
+};
 
-// The screen has it's own coordinate system, so we need to convert the coordinates of the shape to the screen coordinates
-// with the top left corner being (0, 0) and the bottom right corner being (800, 800)
-// and (0, 0) being the center of the screen as (400, 400)
-// Get actual coordinates of the x axis
-float yCoordinate(const float& y)
+// Input thread: reads the commands from the console and passes them to the render loop through the queue.
+// When they are typed in a terminal, it waits before asking for the next command until the render loop applied
+// the previous one and printed the vertices, so the prompts and the vertices stay in order. Piped commands are
+// parsed ahead without prompts and fill the queue, the render loop applies a batch of them per frame
+void readInput(shared_ptr<InputChannel> channel)
 {
-    return (y / -100) + 4;
+    InputQueue& queue = channel->queue;
+    atomic<unsigned int>& processed = channel->processed;
+    setTraceThreadName("input");
+    unsigned int sent = 0;
+    InputMessage message = { InputAction::Transform, TransformCommand(), 0 };
+    while (message.action != InputAction::Exit)
+    {
+        try
+        {
+            readCommand(message);
+        }
+        catch (runtime_error&)
+        {
+            message.action = InputAction::Exit;
+        }
+
+        while (!queue.push(message))
+        {
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        ++sent;
+        while (channel->lockStep && message.action != InputAction::Exit && processed.load() != sent)
+        {
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    }
 }
-// Get actual coordinates of the y axis
-float xCoordinate(const float& x)
+
+// Function to apply a message from the input thread to the pipeline. Undo, redo and going to a step
+// only select another matrix of the journal, the vertices are evaluated when they are displayed
+// Returns false if the step to go to does not exist
+bool applyMessage(TransformPipeline& pipeline, const InputMessage& message)
 {
-    return (x / 100) - 4;
+    switch (message.action)
+    {
+    case InputAction::Transform:
+        // A new transformation discards the steps that were undone
+        applyCommand(pipeline, message.command);
+        return true;
+    case InputAction::Undo:
+        return pipeline.undo();
+    case InputAction::Redo:
+        return pipeline.redo();
+    case InputAction::JumpTo:
+        return pipeline.jumpTo(message.step);
+    default:
+        return true;
+    }
 }
-// Get on window placement of the x axis
-float yPlacement(const float& y)
+
+// Function to tell the user where the session is in the journal after a message was applied
+void printStep(const TransformPipeline& pipeline, const InputMessage& message, bool applied)
 {
-    return ((4 - y) * 100);
+    if (!applied && message.action == InputAction::Undo)
+        cout << "Nothing to undo" << endl;
+    else if (!applied && message.action == InputAction::Redo)
+        cout << "Nothing to redo" << endl;
+    else if (!applied)
+        cout << "There are only " << pipeline.stepCount() << " steps" << endl;
+    cout << "Step " << pipeline.step() << " of " << pipeline.stepCount() << endl;
 }
-// Get on window placement of the y axis
-float xPlacement(const float& x)
+
+// Function to bring the reference of the verification mode to the current step, it is rebuilt from
+// the original vertices when the pipeline went back, with the commands of the journal
+void updateReference(ReferenceTransform& reference, const TransformPipeline& pipeline)
 {
-    return ((4 + x) * 100);
+    if (reference.steps() > pipeline.step())
+    {
+        reference = ReferenceTransform(pipeline.original());
+    }
+    while (reference.steps() < pipeline.step())
+    {
+        reference.apply(pipeline.command(reference.steps() + 1));
+    }
 }
 
+// Command line options
+struct Options
+{
+    string verticesPath;
+    string scriptPath;
+    string outputPath;
+    string imagePath;
+    string recordPath;
+    string replayPath;
+    string profileCsvPath;
+    string tracePath;
+    vector<string> partPaths;
+    Verbosity verbosity = Verbosity::Full;
+    bool stream = false;
+    bool verify = false;
+    bool profile = false;
+};
 
+// The batch mode runs without a window when there is a command file or an image to render
+bool isBatch(const Options& options)
+{
+    return !options.scriptPath.empty() || !options.imagePath.empty() || options.stream;
+}
+
+// Function to read the command line options
+bool parseArguments(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string argument = argv[i];
+        if (argument == "--vertices" && i + 1 < argc)
+        {
+            options.verticesPath = argv[++i];
+        }
+        else if (argument == "--script" && i + 1 < argc)
+        {
+            options.scriptPath = argv[++i];
+        }
+        else if (argument == "--output" && i + 1 < argc)
+        {
+            options.outputPath = argv[++i];
+        }
+        else if (argument == "--part" && i + 1 < argc)
+        {
+            options.partPaths.push_back(argv[++i]);
+        }
+        else if (argument == "--image" && i + 1 < argc)
+        {
+            options.imagePath = argv[++i];
+        }
+        else if (argument == "--record" && i + 1 < argc)
+        {
+            options.recordPath = argv[++i];
+        }
+        else if (argument == "--replay" && i + 1 < argc)
+        {
+            options.replayPath = argv[++i];
+        }
+        else if (argument == "--verbosity" && i + 1 < argc && parseVerbosity(argv[i + 1], options.verbosity))
+        {
+            ++i;
+        }
+        else if (argument == "--stream")
+        {
+            options.stream = true;
+        }
+        else if (argument == "--verify")
+        {
+            options.verify = true;
+        }
+        else if (argument == "--trace" && i + 1 < argc)
+        {
+            options.tracePath = argv[++i];
+        }
+        else if (argument == "--profile")
+        {
+            options.profile = true;
+        }
+        else if (argument == "--profile-csv" && i + 1 < argc)
+        {
+            options.profile = true;
+            options.profileCsvPath = argv[++i];
+        }
+        else
+        {
+            cout << "Usage: AffineT [--vertices file] [--script file] [--output file] [--image file] [--verbosity quiet|summary|full] [--stream] [--verify] [--trace file]" << endl;
+            cout << "       AffineT --vertices file --part file [--part file ...] [--script file] [--output file] [--image file] [--trace file]" << endl;
+            cout << "       AffineT [--record file] [--profile] [--profile-csv file] | --replay file [--output file] [--verify] [--trace file]" << endl;
+            return false;
+        }
+    }
+    if (!options.replayPath.empty() && (!options.verticesPath.empty() || isBatch(options) || !options.recordPath.empty()))
+    {
+        cout << "The replay mode takes the vertices and the commands from the journal" << endl;
+        return false;
+    }
+    if (!options.recordPath.empty() && isBatch(options))
+    {
+        cout << "Only the interactive sessions can be recorded" << endl;
+        return false;
+    }
+    if (options.profile && (isBatch(options) || !options.replayPath.empty()))
+    {
+        cout << "Only the frames of the interactive sessions can be profiled" << endl;
+        return false;
+    }
+    if (options.stream && (!options.imagePath.empty() || options.verify))
+    {
+        cout << "The streaming mode cannot render an image or verify the vertices" << endl;
+        return false;
+    }
+    if (!options.partPaths.empty() && (!isBatch(options) || options.stream || options.verify))
+    {
+        cout << "The assemblies are only transformed by the batch mode, without --stream or --verify" << endl;
+        return false;
+    }
+    if (isBatch(options) && !options.stream && options.verticesPath.empty())
+    {
+        cout << "The batch mode needs the vertices file: AffineT --vertices file [--script file] [--output file] [--image file]" << endl;
+        return false;
+    }
+    return true;
+}
 
+// Function to print the largest error of the transformed vertices against the high precision reference
+void printPrecision(ostream& output, const ReferenceTransform& reference, const VertexStore& vertices)
+{
+    PrecisionReport report = reference.compare(vertices);
+    output << "Max error after " << reference.steps() << " transformations in " << scalarName << ": " << report.maxError
+           << " (vertex " << report.worstVertex + 1 << ")" << endl;
+}
 
-// Affine transformations: translation, scaling, rotation, and shaering
-// Function to apply translation to a shape
-void applyTranslation(sf::ConvexShape& shape, float dx, float dy)
+// Function to render the coordinate system and the shapes of a scene to an image file with the software
+// rasterizer, so it works without a display or a GPU
+bool renderScene(const string& path, const ShapeScene& scene)
+{
+    SoftwareRenderTarget target(window_width, window_height);
+    target.clear();
+    target.draw(createCoordinateSystem(window_width, window_height, 100.0f / shape_scale));
+    target.draw(scene.getTriangles(), screenTransform());
+    return target.saveToFile(path);
+}
+
+// Function to render the original shape and the transformed shape to an image file
+bool renderImage(const string& path, const VertexStore& original, const VertexStore& transformed)
+{
+    TraceZone zone("render image");
+    ShapeScene scene;
+    scene.addShape(original, sf::Color::Green, sf::Color::White, outlineThickness());
+    scene.addShape(transformed, sf::Color::Red, sf::Color::White, outlineThickness());
+    return renderScene(path, scene);
+}
+
+// Function to render the original and the transformed shapes of an assembly to an image file
+bool renderImage(const string& path, const SceneGraph& assembly)
 {
-    for (size_t i = 0; i < shape.getPointCount(); ++i) {
-        sf::Vector2f point = shape.getPoint(i);
-        point.x += (dx*100);
-        point.y -= (dy*100); // Invert y-axis to match Cartesian coordinates
-        shape.setPoint(i, point);
+    TraceZone zone("render image");
+    ShapeScene scene;
+    for (SceneGraph::NodeId id = 0; id < assembly.nodeCount(); ++id)
+    {
+        if (assembly.hasGeometry(id))
+        {
+            scene.addShape(assembly.original(id), sf::Color::Green, sf::Color::White, outlineThickness());
+            scene.addShape(assembly.vertices(id), sf::Color::Red, sf::Color::White, outlineThickness());
+        }
     }
+    return renderScene(path, scene);
 }
 
-// Function to apply scaling to a shape
-void applyScaling(sf::ConvexShape& shape, float sx, float sy)
+// Function to put the vertices of all the shapes of an assembly one after the other, original or transformed
+VertexStore joinShapes(const SceneGraph& assembly, bool transformed)
 {
-    for (size_t i = 0; i < shape.getPointCount(); ++i) {
-        sf::Vector2f point = shape.getPoint(i);
-        point.x = xPlacement(sx*xCoordinate(point.x));
-        point.y = yPlacement(sy*yCoordinate(point.y));
-        shape.setPoint(i, point);
+    size_t count = 0;
+    for (SceneGraph::NodeId id = 0; id < assembly.nodeCount(); ++id)
+    {
+        count += assembly.original(id).size();
     }
+    VertexStore joined(count);
+    size_t offset = 0;
+    for (SceneGraph::NodeId id = 0; id < assembly.nodeCount(); ++id)
+    {
+        const VertexStore& vertices = transformed ? assembly.vertices(id) : assembly.original(id);
+        copy(vertices.x(), vertices.x() + vertices.size(), joined.x() + offset);
+        copy(vertices.y(), vertices.y() + vertices.size(), joined.y() + offset);
+        offset += vertices.size();
+    }
+    return joined;
 }
 
-// Function to apply rotation to a shape
-void applyRotation(sf::ConvexShape& shape, float angle)
+// Streaming mode: the vertices are read from the file (or the standard input when there is no file or it is "-")
+// and written to the output chunk by chunk, so they never have to fit in memory
+int runStream(const Options& options)
 {
-    float radians = angle * PI / 180.0f;
-    for (size_t i = 0; i < shape.getPointCount(); ++i)
+    string error;
+    vector<TransformCommand> commands;
+    if (!options.scriptPath.empty() && !loadTransformScript(options.scriptPath, commands, error))
+    {
+        cerr << error << endl;
+        return 1;
+    }
+
+    // The pipeline has no vertices, it is only used to compose the matrix
+    TransformPipeline pipeline{ VertexStore() };
+    for (const TransformCommand& command : commands)
+    {
+        applyCommand(pipeline, command);
+    }
+
+    bool fromStdin = options.verticesPath.empty() || options.verticesPath == "-";
+    FILE* input = fromStdin ? stdin : fopen(options.verticesPath.c_str(), "rb");
+    FILE* output = options.outputPath.empty() ? stdout : fopen(options.outputPath.c_str(), "wb");
+    bool streamed = false;
+    if (!input)
+        error = "Could not open " + options.verticesPath;
+    else if (!output)
+        error = "Could not open " + options.outputPath + " for writing";
+    else
+    {
+        StreamStats stats;
+        streamed = streamVertices(input, output, pipeline.matrix(), defaultStreamChunk, stats, error);
+    }
+
+    if (input && input != stdin)
+        fclose(input);
+    if (output && output != stdout && fclose(output) != 0 && streamed)
+    {
+        streamed = false;
+        error = "Could not write " + options.outputPath;
+    }
+    if (!streamed)
     {
-        sf::Vector2f point = shape.getPoint(i);
-		float x = xCoordinate(point.x);
-		float y = yCoordinate(point.y);
-        float x_new = xPlacement(x * cos(radians) - y * sin(radians));
-        float y_new = yPlacement(x * sin(radians) + y * cos(radians));
-        shape.setPoint(i, sf::Vector2f(x_new, y_new));
+        cerr << error << endl;
+        return 1;
     }
+    return 0;
 }
 
-// Function to apply shearing to a shape
-void applyShearing(sf::ConvexShape& shape, float shx, float shy)
-{
-	for (size_t i = 0; i < shape.getPointCount(); ++i)
-	{
-		sf::Vector2f point = shape.getPoint(i);
-		float x = xCoordinate(point.x);
-		float y = yCoordinate(point.y);
-		float x_new = xPlacement(x + shx * y);
-		float y_new = yPlacement(y + shy * x);
-		shape.setPoint(i, sf::Vector2f(x_new, y_new));
-	}
+// Batch mode: the whole command file is parsed and composed first, then the vertices are transformed
+// in a single pass and written to the output file (or the standard output) without opening a window.
+// With an image path the shapes are also rendered offscreen
+int runBatch(const Options& options)
+{
+    string error;
+    vector<TransformCommand> commands;
+    VertexStore vertices;
+    if ((!options.scriptPath.empty() && !loadTransformScript(options.scriptPath, commands, error)) ||
+        !loadVertexFile(options.verticesPath, vertices, error))
+    {
+        cerr << error << endl;
+        return 1;
+    }
+    setShapeScale(vertices);
+
+    // Without --verify the reference is left empty
+    ReferenceTransform reference(options.verify ? vertices : VertexStore());
+    TransformPipeline pipeline(move(vertices));
+    for (const TransformCommand& command : commands)
+    {
+        applyCommand(pipeline, command);
+        reference.apply(command);
+    }
+
+    // The vertices go to the standard output unless only an image was asked for
+    if ((!options.outputPath.empty() || options.imagePath.empty()) &&
+        !saveVertexFile(options.outputPath, pipeline.vertices(), error))
+    {
+        cerr << error << endl;
+        return 1;
+    }
+
+    if (!options.imagePath.empty() && !renderImage(options.imagePath, pipeline.original(), pipeline.vertices()))
+    {
+        cerr << "Could not write " << options.imagePath << endl;
+        return 1;
+    }
+
+    // The report goes to the error stream, the standard output may hold the vertices
+    if (options.verify)
+    {
+        printPrecision(cerr, reference, pipeline.vertices());
+    }
+    return 0;
 }
 
-// Function to print the vertices of a shape
-void printShapeVertices(const sf::ConvexShape& shape)
+// Assembly mode: the shape of --vertices and the shapes of --part are the parts 1, 2, ... of an assembly, held by
+// a scene graph under its root. The commands are applied in the order of the file: they are appended to the root,
+// or to the part selected by the last "part n" line after the matrix of the root was pushed into the parts, so a
+// part command acts after the whole assembly commands before it. The world matrix of each part is applied once
+// to its vertices. The transformed parts are written one after the other to the output, and rendered together
+// to the image
+int runAssembly(const Options& options)
 {
-    cout << "Shape Vertices:" << endl;
-    for (size_t i = 0; i < shape.getPointCount(); ++i)
+    string error;
+    vector<string> paths(1, options.verticesPath);
+    paths.insert(paths.end(), options.partPaths.begin(), options.partPaths.end());
+    vector<PartCommand> commands;
+    if (!options.scriptPath.empty() && !loadAssemblyScript(options.scriptPath, paths.size(), commands, error))
     {
-        sf::Vector2f point = shape.getPoint(i);
-        cout << "Vertex " << i + 1 << ": (" << xCoordinate(point.x) << ", " << yCoordinate(point.y) << ")" << endl;
+        cerr << error << endl;
+        return 1;
     }
+
+    // The parts are added in order under the root, so the id of part n is n
+    SceneGraph assembly;
+    for (const string& path : paths)
+    {
+        VertexStore vertices;
+        if (!loadVertexFile(path, vertices, error))
+        {
+            cerr << error << endl;
+            return 1;
+        }
+        assembly.addShape(SceneGraph::root, move(vertices));
+    }
+    setShapeScale(joinShapes(assembly, false));
+
+    {
+        TraceZone zone("transform assembly");
+        for (const PartCommand& command : commands)
+        {
+            if (command.part != SceneGraph::root)
+            {
+                assembly.pushToChildren(SceneGraph::root);
+            }
+            assembly.append(command.part, commandMatrix(command.command));
+        }
+        assembly.update();
+    }
+
+    if ((!options.outputPath.empty() || options.imagePath.empty()) &&
+        !saveVertexFile(options.outputPath, joinShapes(assembly, true), error))
+    {
+        cerr << error << endl;
+        return 1;
+    }
+
+    if (!options.imagePath.empty() && !renderImage(options.imagePath, assembly))
+    {
+        cerr << "Could not write " << options.imagePath << endl;
+        return 1;
+    }
+    return 0;
 }
 
-// Main function
-int main() 
+// Replay mode: the vertices and the actions of a recorded session are executed again without a window, as
+// fast as possible. Each action is timed including the evaluation of the vertices the session displayed
+int runReplay(const Options& options)
+{
+    string error;
+    VertexStore vertices;
+    vector<InputMessage> messages;
+    if (!loadSessionJournal(options.replayPath, vertices, messages, error))
+    {
+        cerr << error << endl;
+        return 1;
+    }
+
+    ReferenceTransform reference(options.verify ? vertices : VertexStore());
+    TransformPipeline pipeline(move(vertices));
+    vector<double> timings;
+    timings.reserve(messages.size());
+    size_t failed = 0;
+    for (const InputMessage& message : messages)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        if (!applyMessage(pipeline, message))
+        {
+            ++failed;
+        }
+        pipeline.vertices();
+        timings.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+    }
+
+    // The report is printed after the replay so writing it is not part of the timings
+    double total = 0;
+    double slowest = 0;
+    cout << "Replayed " << messages.size() << " actions on " << pipeline.original().size() << " vertices" << endl;
+    for (size_t i = 0; i < messages.size(); ++i)
+    {
+        const InputMessage& message = messages[i];
+        cout << i + 1 << '\t';
+        if (message.action == InputAction::Transform && message.command.type == TransformType::Rotation)
+            cout << transformTypeName(message.command.type) << ' ' << message.command.x;
+        else if (message.action == InputAction::Transform)
+            cout << transformTypeName(message.command.type) << ' ' << message.command.x << ' ' << message.command.y;
+        else if (message.action == InputAction::Undo)
+            cout << "undo";
+        else if (message.action == InputAction::Redo)
+            cout << "redo";
+        else
+            cout << "step " << message.step;
+        cout << '\t' << timings[i] << " ms" << endl;
+        total += timings[i];
+        slowest = max(slowest, timings[i]);
+    }
+    cout << "Total " << total << " ms, mean " << (messages.empty() ? 0 : total / messages.size())
+         << " ms, slowest " << slowest << " ms, final step " << pipeline.step() << " of " << pipeline.stepCount() << endl;
+    if (failed > 0)
+    {
+        cout << failed << " actions had no step to go to" << endl;
+    }
+
+    if (!options.outputPath.empty() && !saveVertexFile(options.outputPath, pipeline.vertices(), error))
+    {
+        cerr << error << endl;
+        return 1;
+    }
+    if (options.verify)
+    {
+        updateReference(reference, pipeline);
+        printPrecision(cout, reference, pipeline.vertices());
+    }
+    return 0;
+}
+
+// Interactive mode: the shapes are shown in a window while the transformations are read from the console
+int runInteractive(const Options& options)
 {
-    // Window settings
+    // Get the coordinates of the vertices from the file or from the user
+    VertexStore vertices;
+    if (!options.verticesPath.empty())
+    {
+        string error;
+        if (!loadVertexFile(options.verticesPath, vertices, error))
+        {
+            cout << error << endl;
+            return 1;
+        }
+    }
+    else
+    {
+        try
+        {
+            size_t numVertices = getIntegerInput("Enter the number of vertices (3 to " + to_string(max_typed_vertices) +
+                                                 ", load larger shapes with --vertices): ", 3, max_typed_vertices);
+            vertices = getVertices(numVertices);
+        }
+        catch (runtime_error&)
+        {
+            return 1;
+        }
+    }
+    setShapeScale(vertices);
+
+    // The session is recorded from the vertices on, so it can be replayed with --replay
+    SessionRecorder recorder;
+    if (!options.recordPath.empty())
+    {
+        string error;
+        if (!recorder.open(options.recordPath, error) || !recorder.recordVertices(vertices))
+        {
+            cout << (error.empty() ? "Could not write " + options.recordPath : error) << endl;
+            return 1;
+        }
+    }
+
+    // Window settings, the loop renders at a steady frame rate whatever the console is doing
     sf::RenderWindow window(sf::VideoMode(window_width, window_height), "Karam's code");
+    window.setFramerateLimit(60);
 
-    // Get number of vertices from user
-    size_t numVertices = getIntegerInput("Enter the number of vertices (min 3, max 10): ", 3, 10);
+    // The original shape and a copy of it for the transformations are packed in one scene, drawn in a single call
+    ShapeScene scene;
+    scene.addShape(vertices, sf::Color::Green, sf::Color::White, outlineThickness());
+    size_t transformedShape = scene.addShape(vertices, sf::Color::Red, sf::Color::White, outlineThickness());
+    scene.setView(screenTransform());
 
-    // Get the coordinates of the vertices from the user
-    vector<sf::Vector2f> vertices = getVertices(numVertices);
+    // The transformations are composed in the pipeline and only evaluated when the shape is drawn or printed
+    // The reference follows undo and redo with the commands kept in the journal of the pipeline
+    ReferenceTransform reference(options.verify ? vertices : VertexStore());
+    TransformPipeline pipeline(move(vertices));
+    unsigned int shapeRevision = pipeline.revision();
 
-    // Create the original shape for visualization
-    sf::ConvexShape originalShape = createShape(vertices);
+    // The grid is kept in a static buffer and only rebuilt when the scale changes
+    CoordinateGrid grid;
 
-    // Create a copy of the shape for transformations
-    sf::ConvexShape transformedShape = originalShape;
-    transformedShape.setFillColor(sf::Color::Red);
+    // Print the vertices of the shape, then start reading the commands on their own thread
+    VertexPrinter printer(options.verbosity);
+    printer.print(pipeline.vertices());
+    shared_ptr<InputChannel> channel = make_shared<InputChannel>(console_input.isTerminal());
+    show_prompts = channel->lockStep;
+    thread inputThread(readInput, channel);
+    bool inputFinished = false;
+
+    // The profiler costs a test of a flag per phase when it is disabled
+    FrameProfiler profiler;
+    profiler.setEnabled(options.profile);
+    ProfilerOverlay overlay;
+    overlay.setVisible(options.profile);
 
 
     // Main loop
+    // A frame is only produced when the shape, the transformation or the view changed, or when the window
+    // has to be repainted, otherwise the loop sleeps for a frame so an idle window costs almost nothing
+    // While the profiler overlay is shown every frame is produced, so the graph shows the cost of a frame
+    const sf::Time idleFrameTime = sf::milliseconds(16);
+    bool needsRedraw = true;
     while (window.isOpen()) 
     {
-		// Event handling for closing the window
+        profiler.beginFrame();
+
+		// Event handling for closing the window and repainting it when it was resized or brought back to front
+        // F3 shows or hides the profiler overlay
         sf::Event event;
         while (window.pollEvent(event))
         {
             if (event.type == sf::Event::Closed)
                 window.close();
+            else if (event.type == sf::Event::Resized || event.type == sf::Event::GainedFocus)
+                needsRedraw = true;
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3 && profiler.isEnabled())
+            {
+                overlay.setVisible(!overlay.isVisible());
+                needsRedraw = true;
+            }
         }
 
-        // Render the coordinate system and the shapes
-        window.clear();
-        drawCoordinateSystem(window);
-        window.draw(originalShape);
-        window.draw(transformedShape);
-        window.display();
-
-		// Print the vertices of the transformed shape
-		printShapeVertices(transformedShape);
+        // Apply the transformations sent by the input thread, at most a queue of them per frame so the window
+        // keeps rendering while piped commands arrive
+        InputMessage message;
+        for (size_t handled = 0; handled < inputBatchSize && window.isOpen() && channel->queue.pop(message); ++handled)
+        {
+            if (message.action == InputAction::Exit)
+            {
+                inputFinished = true;
+                window.close();
+                break;
+            }
+            bool applied;
+            {
+                ScopedTimer timer(profiler, FramePhase::Input);
+                if (recorder.isOpen() && !recorder.record(message))
+                {
+                    cout << "Could not write " << options.recordPath << ", the recording stops" << endl;
+                    recorder.close();
+                }
+                applied = applyMessage(pipeline, message);
+            }
 
-        // Ask the user for the transformation type and amount
-        int transformationType;
-        
-		transformationType = getIntegerInput("Enter the transformation type (1: translation, 2: scaling, 3: rotation, 4: shearing, 5: exit): ", 1, 5);
+            // The vertices are evaluated before printing, so the console phase only measures the output
+            {
+                ScopedTimer timer(profiler, FramePhase::Transform);
+                pipeline.vertices();
+            }
 
-		// Apply the transformation based on the user input
-        if (transformationType == 5)
+            // Print the vertices of the transformed shape
+            {
+                ScopedTimer timer(profiler, FramePhase::Console);
+                TraceZone zone("print vertices");
+                printStep(pipeline, message, applied);
+                printer.print(pipeline.vertices());
+                if (options.verify)
+                {
+                    updateReference(reference, pipeline);
+                    printPrecision(cout, reference, pipeline.vertices());
+                }
+            }
+            ++channel->processed;
+        }
+        if (!window.isOpen())
         {
             break;
         }
-        else if (transformationType == 1)
+
+        // Update the transformed shape if a transformation was applied since the last frame
         {
-            float dx, dy;
-			dx = getFloatInput("Enter translation amount dx: ", -4, 4);
-			dy = getFloatInput("Enter translation amount dy: ", -4, 4);
-            applyTranslation(transformedShape, dx, dy);
+            ScopedTimer timer(profiler, FramePhase::Transform);
+            if (shapeRevision != pipeline.revision())
+            {
+                scene.updateShape(transformedShape, pipeline.vertices());
+                shapeRevision = pipeline.revision();
+            }
+            if (scene.update())
+            {
+                needsRedraw = true;
+            }
         }
-        else if (transformationType == 2)
+
+        // The grid only changes with the view
         {
-            float sx, sy;
-			sx = getFloatInput("Enter scaling factors (sx): ", 0, 4);
-			sy = getFloatInput("Enter scaling factors (sy): ", 0, 4);
-            applyScaling(transformedShape, sx, sy);
+            ScopedTimer timer(profiler, FramePhase::Grid);
+            if (grid.update(window_width, window_height, 100.0f / shape_scale))
+            {
+                needsRedraw = true;
+            }
         }
-        else if (transformationType == 3)
+
+        if (!needsRedraw && !overlay.isVisible())
         {
-            float angle;
-			angle = getFloatInput("Enter rotation angle (degrees): ", -360, 360);
-            applyRotation(transformedShape, angle);
+            sf::sleep(idleFrameTime);
+            continue;
         }
-        else if (transformationType == 4)
+
+        // Render the coordinate system and the shapes, the overlay shows the frames measured so far
         {
-            float shx, shy;
-			shx = getFloatInput("Enter shearing factors (shx): ", -4, 4);
-			shy = getFloatInput("Enter shearing factors (shy): ", -4, 4);
-			applyShearing(transformedShape, shx, shy);
+            ScopedTimer timer(profiler, FramePhase::Draw);
+            window.clear();
+            {
+                TraceZone zone("draw grid");
+                window.draw(grid);
+            }
+            {
+                TraceZone zone("draw shapes");
+                window.draw(scene);
+            }
+            if (overlay.isVisible())
+            {
+                TraceZone zone("draw profiler");
+                overlay.update(profiler);
+                window.draw(overlay);
+            }
         }
-        else {
-            cout << "Invalid transformation type. Please try again." << endl;
+        {
+            ScopedTimer timer(profiler, FramePhase::Display);
+            TraceZone zone("display");
+            window.display();
         }
+        needsRedraw = false;
+        profiler.endFrame();
+    }
 
+    if (!options.profileCsvPath.empty() && !profiler.saveCsv(options.profileCsvPath))
+    {
+        cout << "Could not write " << options.profileCsvPath << endl;
     }
 
+    // If the window was closed while the input thread waits for the console it cannot be interrupted,
+    // so it is left behind and main ends the process without destroying the objects the thread uses
+    if (inputFinished)
+    {
+        inputThread.join();
+    }
+    else
+    {
+        inputThread.detach();
+        input_thread_left = true;
+    }
     return 0;
 }
+
+// Main function
+int main(int argc, char* argv[]) 
+{
+    Options options;
+    if (!parseArguments(argc, argv, options))
+    {
+        return 1;
+    }
+
+    // The trace covers the whole run of the mode, it is written by its own thread while the mode runs
+    if (!options.tracePath.empty())
+    {
+        string error;
+        if (!startTrace(options.tracePath, error))
+        {
+            cerr << error << endl;
+            return 1;
+        }
+        setTraceThreadName("main");
+    }
+
+    int result;
+    if (options.stream)
+    {
+        result = runStream(options);
+    }
+    else if (!options.replayPath.empty())
+    {
+        result = runReplay(options);
+    }
+    else if (!options.partPaths.empty())
+    {
+        result = runAssembly(options);
+    }
+    else if (isBatch(options))
+    {
+        result = runBatch(options);
+    }
+    else
+    {
+        result = runInteractive(options);
+    }
+
+    if (!options.tracePath.empty())
+    {
+        size_t dropped = stopTrace();
+        if (dropped > 0)
+        {
+            cerr << dropped << " trace events were dropped, the threads recorded them faster than they were written" << endl;
+        }
+    }
+
+    // The static objects, such as the console reader and the standard input, are still used by an input thread
+    // left waiting for the console, so they are not destroyed: the output is flushed and the process ends
+    if (input_thread_left)
+    {
+        cout.flush();
+        fflush(stdout);
+        quick_exit(result);
+    }
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "ConsoleInput.h"
+#include <charconv>
+#include <cstring>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+using namespace std;
+
+namespace
+{
+    // Size of the stdio buffer of the input, a piped command stream is read a block at a time
+    const size_t inputBlockSize = 1 << 16;
+
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // Function to read the rest of a line like fgets, but returning the number of bytes read, which strlen
+    // cannot give when the line holds NUL bytes. The space is filled with newlines first: fgets stops after
+    // the first newline of the input, so the first newline in the space is either the one read, followed
+    // by the terminating NUL, or the filling right after the terminating NUL. Returns 0 at the end of the input
+    size_t readLinePart(char* data, size_t size, FILE* file)
+    {
+        memset(data, '\n', size);
+        if (!fgets(data, static_cast<int>(size), file))
+            return 0;
+        const char* newline = static_cast<const char*>(memchr(data, '\n', size));
+        if (!newline)
+            return size - 1;
+        size_t position = newline - data;
+        if (position + 1 < size && data[position + 1] == '\0')
+            return position + 1;
+        return position - 1;
+    }
+
+    template <typename T>
+    NumberStatus parseWholeToken(const char* begin, const char* end, T& value)
+    {
+        if (begin < end && *begin == '+')
+            ++begin;
+        from_chars_result result = from_chars(begin, end, value);
+        if (result.ec == errc::result_out_of_range)
+            return NumberStatus::OutOfRange;
+        if (result.ec != errc() || result.ptr != end)
+            return NumberStatus::Invalid;
+        return NumberStatus::Valid;
+    }
+}
+
+NumberStatus parseNumber(const char* begin, const char* end, int& value)
+{
+    return parseWholeToken(begin, end, value);
+}
+
+NumberStatus parseNumber(const char* begin, const char* end, double& value)
+{
+    return parseWholeToken(begin, end, value);
+}
+
+ConsoleInput::ConsoleInput(FILE* file) :
+    m_file(file),
+    m_line(256),
+    m_position(0),
+    m_length(0),
+    m_lineNumber(0),
+    m_column(0)
+{
+    setvbuf(m_file, nullptr, _IOFBF, inputBlockSize);
+}
+
+bool ConsoleInput::nextToken(const char*& begin, const char*& end)
+{
+    for (;;)
+    {
+        const char* data = m_line.data();
+        while (m_position < m_length && isSpace(data[m_position]))
+            ++m_position;
+        if (m_position < m_length)
+            break;
+        if (!readLine())
+            return false;
+    }
+
+    const char* data = m_line.data();
+    size_t first = m_position;
+    while (m_position < m_length && !isSpace(data[m_position]))
+        ++m_position;
+    begin = data + first;
+    end = data + m_position;
+    m_column = first + 1;
+    return true;
+}
+
+bool ConsoleInput::isTerminal() const
+{
+#ifdef _WIN32
+    return _isatty(_fileno(m_file)) != 0;
+#else
+    return isatty(fileno(m_file)) != 0;
+#endif
+}
+
+size_t ConsoleInput::line() const
+{
+    return m_lineNumber;
+}
+
+size_t ConsoleInput::column() const
+{
+    return m_column;
+}
+
+bool ConsoleInput::readLine()
+{
+    // The buffer grows until it holds the whole line, a line is never split between two reads
+    m_position = 0;
+    m_length = 0;
+    for (;;)
+    {
+        if (m_line.size() - m_length < 2)
+            m_line.resize(m_line.size() * 2);
+        char* data = m_line.data();
+        size_t read = readLinePart(data + m_length, m_line.size() - m_length, m_file);
+        if (read == 0)
+            break;
+        m_length += read;
+        if (data[m_length - 1] == '\n')
+            break;
+    }
+    if (m_length == 0)
+        return false;
+    ++m_lineNumber;
+    return true;
+}
@@ -0,0 +1,58 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: ConsoleInput.h
+
+Description: Reader of the numbers typed in the console or piped to the standard input. The input is
+read a line at a time into a reused buffer, through a large stdio buffer when it is piped, and split
+into tokens in place, so reading a token allocates nothing. The numbers are parsed with from_chars:
+an invalid token is reported with its line and column instead of throwing, which keeps generated
+command streams with malformed lines fast.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+// Result of parsing a number
+enum class NumberStatus
+{
+    Valid,
+    Invalid,    // The token is not a number, or has characters after it
+    OutOfRange  // The number does not fit in the type
+};
+
+// Functions to parse a whole token as a number, an optional '+' is accepted before it
+NumberStatus parseNumber(const char* begin, const char* end, int& value);
+NumberStatus parseNumber(const char* begin, const char* end, double& value);
+
+class ConsoleInput
+{
+public:
+    // The file is given a large buffer, so it must not have been read from before
+    explicit ConsoleInput(FILE* file);
+
+    // Function to get the next token separated by white space. Returns false at the end of the input
+    // NUL bytes are kept in the tokens, which then are not valid numbers
+    bool nextToken(const char*& begin, const char*& end);
+
+    // Function to know if the input is typed in a terminal, rather than piped or redirected from a file
+    bool isTerminal() const;
+
+    // Position of the last token, both starting at 1
+    std::size_t line() const;
+    std::size_t column() const;
+
+private:
+    // Function to read the next line into the buffer. Returns false at the end of the input
+    bool readLine();
+
+    FILE* m_file;
+    std::vector<char> m_line;
+    std::size_t m_position;
+    std::size_t m_length;
+    std::size_t m_lineNumber;
+    std::size_t m_column;
+};
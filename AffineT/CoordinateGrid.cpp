@@ -0,0 +1,197 @@
+#include "CoordinateGrid.h"
+#include "Trace.h"
+#include <cmath>
+#include <sstream>
+using namespace std;
+
+namespace
+{
+    // Major lines are at least this far apart on the screen, minor lines divide them in 4 or 5
+    const float minMajorPixels = 100;
+
+    // Hard limit on the number of lines per axis, whatever the window size is
+    const long maxLinesPerAxis = 50;
+
+    const sf::Color majorColor(200, 200, 200);
+    const sf::Color minorColor(80, 80, 80);
+    const sf::Color axisColor = sf::Color::Blue;
+
+    // Fonts tried for the labels. Without any of them the grid is drawn without labels
+    const char* const fontPaths[] = {
+        "arial.ttf",
+        "C:/Windows/Fonts/arial.ttf",
+        "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+        "/System/Library/Fonts/Supplemental/Arial.ttf"
+    };
+
+    // Function to call visit(k, position) for every multiple k of step visible in [0, size] pixels
+    template <typename Visitor>
+    void forEachLine(float center, float size, double step, float pixelsPerUnit, Visitor visit)
+    {
+        double halfExtent = center / pixelsPerUnit;
+        double farExtent = (size - center) / pixelsPerUnit;
+        long first = static_cast<long>(ceil(-halfExtent / step));
+        long last = static_cast<long>(floor(farExtent / step));
+        for (long k = first; k <= last; ++k)
+        {
+            visit(k, static_cast<float>(center + k * step * pixelsPerUnit));
+        }
+    }
+}
+
+GridSpacing computeGridSpacing(float pixelsPerUnit)
+{
+    GridSpacing spacing = { 1, 0.2 };
+    if (!(pixelsPerUnit > 0) || !isfinite(pixelsPerUnit))
+        return spacing;
+
+    // Smallest 1, 2 or 5 times a power of ten that is at least minMajorPixels wide
+    double target = minMajorPixels / pixelsPerUnit;
+    double power = pow(10.0, floor(log10(target)));
+    double mantissa = target / power;
+    if (mantissa <= 1)
+        spacing.major = power;
+    else if (mantissa <= 2)
+        spacing.major = 2 * power;
+    else if (mantissa <= 5)
+        spacing.major = 5 * power;
+    else
+        spacing.major = 10 * power;
+
+    // 2 splits in 4 (0.5 steps), 1 and 5 split in 5 (0.2 and 1 steps)
+    bool isTwo = fabs(spacing.major / (2 * power) - 1) < 1e-9;
+    spacing.minor = spacing.major / (isTwo ? 4 : 5);
+    return spacing;
+}
+
+sf::VertexArray createCoordinateSystem(unsigned int width, unsigned int height, float pixelsPerUnit) {
+    sf::VertexArray lines(sf::Lines);
+    float centerX = width / 2.0f;
+    float centerY = height / 2.0f;
+
+    if (pixelsPerUnit > 0 && isfinite(pixelsPerUnit))
+    {
+        GridSpacing spacing = computeGridSpacing(pixelsPerUnit);
+        double ratio = spacing.major / spacing.minor;
+
+        // Minor lines are skipped if there would be too many of them for the window size
+        double minor = spacing.minor;
+        if (max(width, height) / (minor * pixelsPerUnit) > maxLinesPerAxis)
+            minor = spacing.major;
+
+        // Draw vertical lines, a minor line is major when its index is a multiple of the ratio
+        forEachLine(centerX, static_cast<float>(width), minor, pixelsPerUnit, [&](long k, float x) {
+            bool isMajor = minor == spacing.major || k % static_cast<long>(round(ratio)) == 0;
+            sf::Color color = isMajor ? majorColor : minorColor;
+            lines.append(sf::Vertex(sf::Vector2f(x, 0), color));
+            lines.append(sf::Vertex(sf::Vector2f(x, static_cast<float>(height)), color));
+        });
+
+        // Draw horizontal lines
+        forEachLine(centerY, static_cast<float>(height), minor, pixelsPerUnit, [&](long k, float y) {
+            bool isMajor = minor == spacing.major || k % static_cast<long>(round(ratio)) == 0;
+            sf::Color color = isMajor ? majorColor : minorColor;
+            lines.append(sf::Vertex(sf::Vector2f(0, y), color));
+            lines.append(sf::Vertex(sf::Vector2f(static_cast<float>(width), y), color));
+        });
+    }
+
+    // Draw x-axis
+    lines.append(sf::Vertex(sf::Vector2f(0, centerY), axisColor));
+    lines.append(sf::Vertex(sf::Vector2f(static_cast<float>(width), centerY), axisColor));
+
+    // Draw y-axis
+    lines.append(sf::Vertex(sf::Vector2f(centerX, 0), axisColor));
+    lines.append(sf::Vertex(sf::Vector2f(centerX, static_cast<float>(height)), axisColor));
+
+    return lines;
+}
+
+bool loadLabelFont(sf::Font& font)
+{
+    for (const char* path : fontPaths)
+    {
+        if (font.loadFromFile(path))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+CoordinateGrid::CoordinateGrid() :
+    m_lines(sf::Lines),
+    m_buffer(sf::Lines, sf::VertexBuffer::Static),
+    m_hasFont(false),
+    m_useBuffer(false),
+    m_built(false),
+    m_width(0),
+    m_height(0),
+    m_pixelsPerUnit(0)
+{
+    m_hasFont = loadLabelFont(m_font);
+}
+
+bool CoordinateGrid::update(unsigned int width, unsigned int height, float pixelsPerUnit)
+{
+    if (m_built && width == m_width && height == m_height && pixelsPerUnit == m_pixelsPerUnit)
+        return false;
+
+    TraceZone zone("rebuild grid");
+    m_lines = createCoordinateSystem(width, height, pixelsPerUnit);
+
+    // Upload the lines once to a static vertex buffer, the vertex array is only kept as a fallback
+    m_useBuffer = sf::VertexBuffer::isAvailable() &&
+                  m_buffer.create(m_lines.getVertexCount()) &&
+                  m_buffer.update(&m_lines[0]);
+    if (m_useBuffer)
+        m_lines.clear();
+
+    createLabels(width, height, pixelsPerUnit);
+
+    m_width = width;
+    m_height = height;
+    m_pixelsPerUnit = pixelsPerUnit;
+    m_built = true;
+    return true;
+}
+
+// Labels are placed next to the axes at every major line except the origin
+void CoordinateGrid::createLabels(unsigned int width, unsigned int height, float pixelsPerUnit)
+{
+    m_labels.clear();
+    if (!m_hasFont || !(pixelsPerUnit > 0) || !isfinite(pixelsPerUnit))
+        return;
+
+    double major = computeGridSpacing(pixelsPerUnit).major;
+    float centerX = width / 2.0f;
+    float centerY = height / 2.0f;
+    auto label = [&](long k, float x, float y) {
+        if (k == 0)
+            return;
+        ostringstream text;
+        text << k * major;
+        sf::Text value(text.str(), m_font, 12);
+        value.setFillColor(majorColor);
+        value.setPosition(x + 2, y + 2);
+        m_labels.push_back(value);
+    };
+
+    forEachLine(centerX, static_cast<float>(width), major, pixelsPerUnit, [&](long k, float x) {
+        label(k, x, centerY);
+    });
+    forEachLine(centerY, static_cast<float>(height), major, pixelsPerUnit, [&](long k, float y) {
+        label(-k, centerX, y);
+    });
+}
+
+void CoordinateGrid::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    if (m_useBuffer)
+        target.draw(m_buffer, states);
+    else
+        target.draw(m_lines, states);
+
+    for (const sf::Text& label : m_labels)
+        target.draw(label, states);
+}
@@ -0,0 +1,58 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: CoordinateGrid.h
+
+Description: Lines of the Cartesian coordinate system. The grid spacing adapts to the visible
+extent: major lines are placed on the first 1, 2 or 5 times a power of ten that is at least
+100 pixels apart, with minor lines in between, so the number of lines stays bounded at any zoom.
+The grid is built once for a window size and scale and kept on the GPU in a static vertex buffer
+(or in a vertex array when vertex buffers are not available), so it is not rebuilt every frame.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+// Spacing of the grid lines in Cartesian units
+struct GridSpacing
+{
+    double major;
+    double minor;
+};
+
+// Function to pick the grid spacing for the given number of pixels per Cartesian unit
+GridSpacing computeGridSpacing(float pixelsPerUnit);
+
+// Function to create the lines of the Cartesian coordinate system, centered in the window
+sf::VertexArray createCoordinateSystem(unsigned int width, unsigned int height, float pixelsPerUnit);
+
+// Function to load the first font found among the usual system fonts, returns false if there is none
+bool loadLabelFont(sf::Font& font);
+
+class CoordinateGrid : public sf::Drawable
+{
+public:
+    CoordinateGrid();
+
+    // Rebuild the grid only if the window size or the scale changed since the last call
+    // Returns true if the grid was rebuilt
+    bool update(unsigned int width, unsigned int height, float pixelsPerUnit);
+
+private:
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+
+    void createLabels(unsigned int width, unsigned int height, float pixelsPerUnit);
+
+    sf::VertexArray m_lines;
+    sf::VertexBuffer m_buffer;
+    std::vector<sf::Text> m_labels;
+    sf::Font m_font;
+    bool m_hasFont;
+    bool m_useBuffer;
+    bool m_built;
+    unsigned int m_width;
+    unsigned int m_height;
+    float m_pixelsPerUnit;
+};
@@ -0,0 +1,142 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: Fixed32.h
+
+Description: Signed 32.32 fixed point number: 32 integer bits and 32 fractional bits in a 64-bit
+integer. Additions and products are integer operations, so a result only depends on the operands
+and never on the processor, the compiler flags (fused multiply-add, vector width) or the math
+library. The range is about +-2.1e9 with a resolution of 2^-32. Floating point values outside of it
+are saturated when converted, and NaN becomes 0; sums and products outside of it wrap around.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+struct Fixed32
+{
+    static const int fractionBits = 32;
+
+    std::int64_t raw;
+
+    Fixed32() :
+        raw(0)
+    {
+    }
+
+    // Integers are converted exactly, so the matrices can be initialized with 0 and 1
+    Fixed32(int value) :
+        raw(static_cast<std::int64_t>(value) * (std::int64_t(1) << fractionBits))
+    {
+    }
+
+    // Floating point values are rounded to the nearest multiple of 2^-32, halfway cases away from zero like
+    // llround. Below 2^52 adding one half is exact, above it the scaled value is already an integer.
+    // The values out of range are clamped before the conversion to the integer, which would be undefined
+    explicit Fixed32(double value) :
+        raw(0)
+    {
+        double scaled = value * 4294967296.0;
+        if (std::isnan(scaled))
+            return;
+        if (scaled >= 9223372036854775808.0)
+            raw = INT64_MAX;
+        else if (scaled <= -9223372036854775808.0)
+            raw = INT64_MIN;
+        else
+        {
+            if (std::fabs(scaled) < 4503599627370496.0)
+                scaled += scaled < 0 ? -0.5 : 0.5;
+            raw = static_cast<std::int64_t>(scaled);
+        }
+    }
+
+    explicit operator double() const
+    {
+        return static_cast<double>(raw) / 4294967296.0;
+    }
+
+    explicit operator float() const
+    {
+        return static_cast<float>(static_cast<double>(*this));
+    }
+
+    static Fixed32 fromRaw(std::int64_t raw)
+    {
+        Fixed32 value;
+        value.raw = raw;
+        return value;
+    }
+
+    Fixed32 operator-() const
+    {
+        return fromRaw(static_cast<std::int64_t>(0 - static_cast<std::uint64_t>(raw)));
+    }
+
+    // The additions go through unsigned integers so an overflow wraps instead of being undefined
+    friend Fixed32 operator+(Fixed32 lhs, Fixed32 rhs)
+    {
+        return fromRaw(static_cast<std::int64_t>(static_cast<std::uint64_t>(lhs.raw) + static_cast<std::uint64_t>(rhs.raw)));
+    }
+
+    friend Fixed32 operator-(Fixed32 lhs, Fixed32 rhs)
+    {
+        return fromRaw(static_cast<std::int64_t>(static_cast<std::uint64_t>(lhs.raw) - static_cast<std::uint64_t>(rhs.raw)));
+    }
+
+    // The 128-bit product is shifted back by 32 bits, rounding halfway cases up. Without a 128-bit integer
+    // type it is built from four 32-bit products, with the same result bit for bit
+    friend Fixed32 operator*(Fixed32 lhs, Fixed32 rhs)
+    {
+#if defined(__SIZEOF_INT128__)
+        __int128 product = static_cast<__int128>(lhs.raw) * rhs.raw + (static_cast<__int128>(1) << 31);
+        return fromRaw(static_cast<std::int64_t>(product >> 32));
+#else
+        std::uint64_t x = static_cast<std::uint64_t>(lhs.raw);
+        std::uint64_t y = static_cast<std::uint64_t>(rhs.raw);
+        std::uint64_t xHigh = x >> 32;
+        std::uint64_t xLow = x & 0xffffffffu;
+        std::uint64_t yHigh = y >> 32;
+        std::uint64_t yLow = y & 0xffffffffu;
+
+        // Unsigned product of the two's complement bits, then corrected for the negative operands
+        std::uint64_t lowLow = xLow * yLow;
+        std::uint64_t lowHigh = xLow * yHigh;
+        std::uint64_t highLow = xHigh * yLow;
+        std::uint64_t middle = (lowLow >> 32) + (lowHigh & 0xffffffffu) + (highLow & 0xffffffffu);
+        std::uint64_t low = (middle << 32) | (lowLow & 0xffffffffu);
+        std::uint64_t high = xHigh * yHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+        if (lhs.raw < 0)
+            high -= y;
+        if (rhs.raw < 0)
+            high -= x;
+
+        std::uint64_t rounded = low + (std::uint64_t(1) << 31);
+        if (rounded < low)
+            ++high;
+        return fromRaw(static_cast<std::int64_t>((high << 32) | (rounded >> 32)));
+#endif
+    }
+
+    Fixed32& operator+=(Fixed32 rhs)
+    {
+        return *this = *this + rhs;
+    }
+
+    Fixed32& operator*=(Fixed32 rhs)
+    {
+        return *this = *this * rhs;
+    }
+
+    friend bool operator==(Fixed32 lhs, Fixed32 rhs)
+    {
+        return lhs.raw == rhs.raw;
+    }
+
+    friend bool operator!=(Fixed32 lhs, Fixed32 rhs)
+    {
+        return lhs.raw != rhs.raw;
+    }
+};
@@ -0,0 +1,138 @@
+#include "FrameProfiler.h"
+#include <algorithm>
+#include <cstdio>
+using namespace std;
+
+namespace
+{
+    // Function to get the value at the given fraction of sorted values
+    float percentile(const vector<float>& sorted, double fraction)
+    {
+        size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[min(index, sorted.size() - 1)];
+    }
+}
+
+const char* framePhaseName(FramePhase phase)
+{
+    switch (phase)
+    {
+    case FramePhase::Input:
+        return "input";
+    case FramePhase::Transform:
+        return "transform";
+    case FramePhase::Console:
+        return "console";
+    case FramePhase::Grid:
+        return "grid";
+    case FramePhase::Draw:
+        return "draw";
+    case FramePhase::Display:
+        return "display";
+    default:
+        return "";
+    }
+}
+
+FrameProfiler::FrameProfiler() :
+    m_frames(capacity),
+    m_current(),
+    m_frameCount(0),
+    m_enabled(false)
+{
+}
+
+void FrameProfiler::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+bool FrameProfiler::isEnabled() const
+{
+    return m_enabled;
+}
+
+void FrameProfiler::beginFrame()
+{
+    if (!m_enabled)
+        return;
+    m_current = FrameSample();
+    m_frameStart = Clock::now();
+}
+
+void FrameProfiler::endFrame()
+{
+    if (!m_enabled)
+        return;
+    m_current.total = chrono::duration<float, milli>(Clock::now() - m_frameStart).count();
+    m_frames[m_frameCount % capacity] = m_current;
+    ++m_frameCount;
+}
+
+void FrameProfiler::add(FramePhase phase, Clock::duration duration)
+{
+    m_current.phases[static_cast<size_t>(phase)] += chrono::duration<float, milli>(duration).count();
+}
+
+size_t FrameProfiler::frameCount() const
+{
+    return m_frameCount;
+}
+
+size_t FrameProfiler::storedFrames() const
+{
+    return min(m_frameCount, capacity);
+}
+
+const FrameSample& FrameProfiler::frame(size_t index) const
+{
+    size_t oldest = m_frameCount > capacity ? m_frameCount % capacity : 0;
+    return m_frames[(oldest + index) % capacity];
+}
+
+FrameStatistics FrameProfiler::statistics() const
+{
+    FrameStatistics statistics = FrameStatistics();
+    statistics.frames = storedFrames();
+    if (statistics.frames == 0)
+        return statistics;
+
+    vector<float> totals;
+    totals.reserve(statistics.frames);
+    for (size_t i = 0; i < statistics.frames; ++i)
+    {
+        const FrameSample& sample = frame(i);
+        totals.push_back(sample.total);
+        for (size_t phase = 0; phase < framePhaseCount; ++phase)
+            statistics.phaseMeans[phase] += sample.phases[phase] / statistics.frames;
+    }
+    sort(totals.begin(), totals.end());
+    statistics.median = percentile(totals, 0.5);
+    statistics.p95 = percentile(totals, 0.95);
+    statistics.p99 = percentile(totals, 0.99);
+    statistics.max = totals.back();
+    return statistics;
+}
+
+bool FrameProfiler::saveCsv(const string& path) const
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "frame,total_ms");
+    for (size_t phase = 0; phase < framePhaseCount; ++phase)
+        fprintf(file, ",%s_ms", framePhaseName(static_cast<FramePhase>(phase)));
+    fprintf(file, "\n");
+
+    size_t first = m_frameCount - storedFrames();
+    for (size_t i = 0; i < storedFrames(); ++i)
+    {
+        const FrameSample& sample = frame(i);
+        fprintf(file, "%zu,%.4f", first + i, sample.total);
+        for (float value : sample.phases)
+            fprintf(file, ",%.4f", value);
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
@@ -0,0 +1,123 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: FrameProfiler.h
+
+Description: Lightweight instrumentation of the main loop. Scoped timers add the time spent in
+each phase of a frame, and the timings of the last frames are kept in a fixed ring buffer, so
+recording never allocates. When the profiler is disabled a timer only tests a flag and never
+reads the clock. The ring buffer gives the frame time percentiles shown by the overlay and can be
+written to a CSV file.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Phases of a frame of the main loop
+enum class FramePhase
+{
+    Input,      // Applying the commands read from the console
+    Transform,  // Evaluating the transformed vertices and updating the shapes
+    Console,    // Printing to the console
+    Grid,       // Rebuilding the coordinate system
+    Draw,       // Clearing the window and drawing
+    Display,    // Presenting the frame, including the wait of the frame rate limit
+    Count
+};
+
+const std::size_t framePhaseCount = static_cast<std::size_t>(FramePhase::Count);
+
+// Name of a phase, used for the overlay and the CSV columns
+const char* framePhaseName(FramePhase phase);
+
+// Timings of one frame in milliseconds
+struct FrameSample
+{
+    std::array<float, framePhaseCount> phases;
+    float total;
+};
+
+// Frame time percentiles over the recorded frames, in milliseconds
+struct FrameStatistics
+{
+    std::size_t frames;
+    float median;
+    float p95;
+    float p99;
+    float max;
+    std::array<float, framePhaseCount> phaseMeans;
+};
+
+class FrameProfiler
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // Number of frames kept in the ring buffer
+    static const std::size_t capacity = 1024;
+
+    FrameProfiler();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    // Function to start a frame, the phases timed before are discarded
+    void beginFrame();
+
+    // Function to store the current frame in the ring buffer
+    void endFrame();
+
+    // Function to add time to a phase of the current frame
+    void add(FramePhase phase, Clock::duration duration);
+
+    // Number of frames recorded since the start, including the ones no longer in the ring buffer
+    std::size_t frameCount() const;
+
+    // Function to get a recorded frame, 0 being the oldest one still in the ring buffer
+    std::size_t storedFrames() const;
+    const FrameSample& frame(std::size_t index) const;
+
+    FrameStatistics statistics() const;
+
+    // Function to write the frames of the ring buffer to a CSV file, one line per frame
+    bool saveCsv(const std::string& path) const;
+
+private:
+    std::vector<FrameSample> m_frames;
+    FrameSample m_current;
+    Clock::time_point m_frameStart;
+    std::size_t m_frameCount;
+    bool m_enabled;
+};
+
+// Timer adding the time until the end of its scope to a phase of the current frame
+class ScopedTimer
+{
+public:
+    ScopedTimer(FrameProfiler& profiler, FramePhase phase) :
+        m_profiler(profiler.isEnabled() ? &profiler : nullptr),
+        m_phase(phase)
+    {
+        if (m_profiler)
+            m_start = FrameProfiler::Clock::now();
+    }
+
+    ~ScopedTimer()
+    {
+        if (m_profiler)
+            m_profiler->add(m_phase, FrameProfiler::Clock::now() - m_start);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    FrameProfiler* m_profiler;
+    FramePhase m_phase;
+    FrameProfiler::Clock::time_point m_start;
+};
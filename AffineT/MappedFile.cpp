@@ -0,0 +1,138 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+MappedFile::MappedFile() :
+    m_data(nullptr),
+    m_size(0)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE),
+    m_mapping(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const string& path, string& error)
+{
+    close();
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        error = "Could not open " + path;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size))
+    {
+        error = "Could not read the size of " + path;
+        close();
+        return false;
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size == 0)
+        return true;
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (m_mapping)
+        m_data = static_cast<char*>(MapViewOfFile(m_mapping, FILE_MAP_COPY, 0, 0, 0));
+    if (!m_data)
+    {
+        error = "Could not map " + path;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+    m_size = 0;
+}
+
+#else
+
+bool MappedFile::open(const string& path, string& error)
+{
+    close();
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        error = "Could not open " + path;
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) != 0)
+    {
+        error = "Could not read the size of " + path;
+        ::close(file);
+        return false;
+    }
+    m_size = static_cast<size_t>(status.st_size);
+    if (m_size == 0)
+    {
+        ::close(file);
+        return true;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    void* data = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (data == MAP_FAILED)
+    {
+        error = "Could not map " + path;
+        m_size = 0;
+        return false;
+    }
+    madvise(data, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<char*>(data);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data)
+        munmap(m_data, m_size);
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
+
+char* MappedFile::data() const
+{
+    return m_data;
+}
+
+size_t MappedFile::size() const
+{
+    return m_size;
+}
@@ -0,0 +1,40 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: MappedFile.h
+
+Description: Read-only file mapped in memory. The pages are mapped copy-on-write, so the content
+can be modified in place without ever changing the file on disk.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Function to map a whole file. On failure the error message is set and false is returned
+    bool open(const std::string& path, std::string& error);
+
+    void close();
+
+    // Start of the mapping, aligned to a page. Null for an empty file
+    char* data() const;
+    std::size_t size() const;
+
+private:
+    char* m_data;
+    std::size_t m_size;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#endif
+};
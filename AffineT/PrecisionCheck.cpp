@@ -0,0 +1,77 @@
+#include "PrecisionCheck.h"
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+namespace
+{
+    const long double PI = 3.141592653589793238462643383279502884L;
+}
+
+ReferenceTransform::ReferenceTransform(const VertexStore& original) :
+    m_x(original.x(), original.x() + original.size()),
+    m_y(original.y(), original.y() + original.size()),
+    m_steps(0)
+{
+}
+
+void ReferenceTransform::apply(const TransformCommand& command)
+{
+    long double x0 = command.x;
+    long double y0 = command.y;
+    long double sine = 0;
+    long double cosine = 1;
+    if (command.type == TransformType::Rotation)
+    {
+        long double radians = x0 * PI / 180;
+        sine = sin(radians);
+        cosine = cos(radians);
+    }
+
+    for (size_t i = 0; i < m_x.size(); ++i)
+    {
+        long double x = m_x[i];
+        long double y = m_y[i];
+        switch (command.type)
+        {
+        case TransformType::Translation:
+            m_x[i] = x + x0;
+            m_y[i] = y + y0;
+            break;
+        case TransformType::Scaling:
+            m_x[i] = x * x0;
+            m_y[i] = y * y0;
+            break;
+        case TransformType::Rotation:
+            m_x[i] = x * cosine - y * sine;
+            m_y[i] = x * sine + y * cosine;
+            break;
+        case TransformType::Shearing:
+            m_x[i] = x + x0 * y;
+            m_y[i] = y0 * x + y;
+            break;
+        }
+    }
+    ++m_steps;
+}
+
+size_t ReferenceTransform::steps() const
+{
+    return m_steps;
+}
+
+PrecisionReport ReferenceTransform::compare(const VertexStore& vertices) const
+{
+    PrecisionReport report = { 0, 0 };
+    size_t count = min(vertices.size(), m_x.size());
+    for (size_t i = 0; i < count; ++i)
+    {
+        long double error = max(fabs(vertices.x()[i] - m_x[i]), fabs(vertices.y()[i] - m_y[i]));
+        if (error > report.maxError)
+        {
+            report.maxError = static_cast<double>(error);
+            report.worstVertex = i;
+        }
+    }
+    return report;
+}
@@ -0,0 +1,42 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: PrecisionCheck.h
+
+Description: High precision reference used by the verification mode. Every command is applied
+directly to the points, one after the other, in long double, and the vertices displayed by the
+program are compared against them to report the largest error accumulated so far.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "TransformScript.h"
+#include "VertexStore.h"
+#include <cstddef>
+#include <vector>
+
+// Largest absolute difference on x or y between the compared vertices and the reference
+struct PrecisionReport
+{
+    double maxError;
+    std::size_t worstVertex;
+};
+
+class ReferenceTransform
+{
+public:
+    explicit ReferenceTransform(const VertexStore& original);
+
+    // Function to apply a command to every reference point
+    void apply(const TransformCommand& command);
+
+    // Number of commands applied so far
+    std::size_t steps() const;
+
+    PrecisionReport compare(const VertexStore& vertices) const;
+
+private:
+    std::vector<long double> m_x;
+    std::vector<long double> m_y;
+    std::size_t m_steps;
+};
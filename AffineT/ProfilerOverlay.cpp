@@ -0,0 +1,117 @@
+#include "ProfilerOverlay.h"
+#include "CoordinateGrid.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+using namespace std;
+
+namespace
+{
+    // The graph shows one pixel per frame, its full height is two frames at 60 frames per second
+    const float graphLeft = 10;
+    const float graphTop = 10;
+    const size_t graphFrames = 256;
+    const float graphHeight = 100;
+    const float graphMilliseconds = 1000.0f / 30;
+
+    const sf::Color backgroundColor(0, 0, 0, 180);
+    const sf::Color guideColor(255, 255, 255, 90);
+    const sf::Color graphColor = sf::Color::Yellow;
+
+    // Function to get the height of the graph for a frame time, clamped to the top of the graph
+    float graphY(float milliseconds)
+    {
+        return graphTop + graphHeight - min(milliseconds / graphMilliseconds, 1.0f) * graphHeight;
+    }
+
+    // Function to set the background to cover the area from the top left corner of the graph to right, bottom
+    void setBackground(sf::VertexArray& background, float right, float bottom)
+    {
+        background[0] = sf::Vertex(sf::Vector2f(graphLeft - 4, graphTop - 4), backgroundColor);
+        background[1] = sf::Vertex(sf::Vector2f(right + 4, graphTop - 4), backgroundColor);
+        background[2] = sf::Vertex(sf::Vector2f(graphLeft - 4, bottom + 4), backgroundColor);
+        background[3] = sf::Vertex(sf::Vector2f(right + 4, bottom + 4), backgroundColor);
+    }
+}
+
+ProfilerOverlay::ProfilerOverlay() :
+    m_background(sf::TriangleStrip, 4),
+    m_guides(sf::Lines),
+    m_graph(sf::LineStrip),
+    m_hasFont(false),
+    m_visible(true)
+{
+    m_hasFont = loadLabelFont(m_font);
+    m_text.setFont(m_font);
+    m_text.setCharacterSize(12);
+    m_text.setFillColor(sf::Color::White);
+    m_text.setPosition(graphLeft, graphTop + graphHeight + 4);
+
+    // The background covers the graph, it is extended to the text under it when the text is set
+    float right = graphLeft + graphFrames;
+    setBackground(m_background, right, graphTop + graphHeight);
+
+    for (float milliseconds : { 1000.0f / 60, 1000.0f / 30 })
+    {
+        m_guides.append(sf::Vertex(sf::Vector2f(graphLeft, graphY(milliseconds)), guideColor));
+        m_guides.append(sf::Vertex(sf::Vector2f(right, graphY(milliseconds)), guideColor));
+    }
+}
+
+void ProfilerOverlay::setVisible(bool visible)
+{
+    m_visible = visible;
+}
+
+bool ProfilerOverlay::isVisible() const
+{
+    return m_visible;
+}
+
+void ProfilerOverlay::update(const FrameProfiler& profiler)
+{
+    if (!m_visible)
+        return;
+
+    // The newest frame is on the right
+    size_t stored = profiler.storedFrames();
+    size_t shown = min(stored, graphFrames);
+    m_graph.resize(shown);
+    for (size_t i = 0; i < shown; ++i)
+    {
+        float milliseconds = profiler.frame(stored - shown + i).total;
+        float x = graphLeft + graphFrames - shown + i;
+        m_graph[i] = sf::Vertex(sf::Vector2f(x, graphY(milliseconds)), graphColor);
+    }
+
+    if (!m_hasFont)
+        return;
+
+    FrameStatistics statistics = profiler.statistics();
+    ostringstream text;
+    text << fixed << setprecision(2);
+    text << "frame ms  p50 " << statistics.median << "  p95 " << statistics.p95 << "  p99 " << statistics.p99
+         << "  max " << statistics.max << "\n";
+    for (size_t phase = 0; phase < framePhaseCount; ++phase)
+    {
+        text << framePhaseName(static_cast<FramePhase>(phase)) << ' ' << statistics.phaseMeans[phase] << "  ";
+    }
+    m_text.setString(text.str());
+
+    // The line of the phases is wider than the graph
+    sf::FloatRect bounds = m_text.getGlobalBounds();
+    setBackground(m_background, max(graphLeft + graphFrames, bounds.left + bounds.width),
+                  max(graphTop + graphHeight, bounds.top + bounds.height));
+}
+
+void ProfilerOverlay::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    if (!m_visible)
+        return;
+
+    target.draw(m_background, states);
+    target.draw(m_guides, states);
+    target.draw(m_graph, states);
+    if (m_hasFont)
+        target.draw(m_text, states);
+}
@@ -0,0 +1,37 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: ProfilerOverlay.h
+
+Description: On-screen view of the frame profiler: a rolling graph of the time of the last frames
+with guides at 60 and 30 frames per second, the frame time percentiles and the mean time of each
+phase. It is drawn in screen coordinates in the top left corner of the window.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "FrameProfiler.h"
+#include <SFML/Graphics.hpp>
+
+class ProfilerOverlay : public sf::Drawable
+{
+public:
+    ProfilerOverlay();
+
+    void setVisible(bool visible);
+    bool isVisible() const;
+
+    // Function to rebuild the graph and the text from the frames recorded by the profiler
+    void update(const FrameProfiler& profiler);
+
+private:
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+
+    sf::VertexArray m_background;
+    sf::VertexArray m_guides;
+    sf::VertexArray m_graph;
+    sf::Font m_font;
+    sf::Text m_text;
+    bool m_hasFont;
+    bool m_visible;
+};
@@ -0,0 +1,188 @@
+#include "RotationCache.h"
+#include <cmath>
+#include <cstdint>
+#include <utility>
+using namespace std;
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+
+    // Constants of the fixed point sine and cosine as raw 32.32 values, rounded from their exact values
+    // so they do not depend on any floating point computation
+    const int64_t fixedRadiansPerDegree = 74961321; // pi / 180
+    const int64_t fixedInverseFactorials[13] = {   // 1 / n! for n from 0 to 12
+        4294967296, 4294967296, 2147483648, 715827883, 178956971, 35791394, 5965232,
+        852176, 106522, 11836, 1184, 108, 9
+    };
+
+    struct SinCos
+    {
+        double sine;
+        double cosine;
+    };
+
+    // Table of the sine and cosine of every whole degree from 0 to 359
+    class RotationTable
+    {
+    public:
+        RotationTable()
+        {
+            // First quadrant, the multiples of 15 degrees are exact and the others are computed in double
+            const double sqrt2 = sqrt(2.0);
+            const double sqrt3 = sqrt(3.0);
+            const double sqrt6 = sqrt(6.0);
+            for (int degree = 0; degree <= 90; ++degree)
+            {
+                double radians = degree * PI / 180.0;
+                m_values[degree].sine = sin(radians);
+                m_values[degree].cosine = cos(radians);
+            }
+            setExact(0, 0, 1);
+            setExact(15, (sqrt6 - sqrt2) / 4, (sqrt6 + sqrt2) / 4);
+            setExact(30, 0.5, sqrt3 / 2);
+            setExact(45, sqrt2 / 2, sqrt2 / 2);
+            setExact(60, sqrt3 / 2, 0.5);
+            setExact(75, (sqrt6 + sqrt2) / 4, (sqrt6 - sqrt2) / 4);
+            setExact(90, 1, 0);
+
+            // The other quadrants are mirrored from the first one so that symmetric angles give symmetric values
+            for (int degree = 91; degree < 360; ++degree)
+            {
+                int quadrant = degree / 90;
+                int offset = degree % 90;
+                const SinCos& base = m_values[offset];
+                SinCos& value = m_values[degree];
+                switch (quadrant)
+                {
+                case 1:
+                    value.sine = base.cosine;
+                    value.cosine = -base.sine;
+                    break;
+                case 2:
+                    value.sine = -base.sine;
+                    value.cosine = -base.cosine;
+                    break;
+                default:
+                    value.sine = -base.cosine;
+                    value.cosine = base.sine;
+                    break;
+                }
+            }
+        }
+
+        const SinCos& operator[](int degree) const
+        {
+            return m_values[degree];
+        }
+
+    private:
+        void setExact(int degree, double sine, double cosine)
+        {
+            m_values[degree].sine = sine;
+            m_values[degree].cosine = cosine;
+        }
+
+        SinCos m_values[360];
+    };
+
+    const RotationTable& rotationTable()
+    {
+        static const RotationTable table;
+        return table;
+    }
+}
+
+void sinCosDegrees(double degrees, double& sine, double& cosine)
+{
+    // Bring the angle to [0, 360)
+    double angle = fmod(degrees, 360.0);
+    if (angle < 0)
+        angle += 360.0;
+
+    if (angle == floor(angle))
+    {
+        const SinCos& value = rotationTable()[static_cast<int>(angle) % 360];
+        sine = value.sine;
+        cosine = value.cosine;
+        return;
+    }
+
+    double radians = angle * PI / 180.0;
+    sine = sin(radians);
+    cosine = cos(radians);
+}
+
+AffineMatrixD rotationMatrix(double degrees)
+{
+    double sine, cosine;
+    sinCosDegrees(degrees, sine, cosine);
+
+    AffineMatrixD m;
+    m.a = cosine;
+    m.b = -sine;
+    m.c = sine;
+    m.d = cosine;
+    return m;
+}
+
+void sinCosDegrees(Fixed32 degrees, Fixed32& sine, Fixed32& cosine)
+{
+    // Bring the angle to [0, 360) and split it into a quadrant and an angle of at most 45 degrees,
+    // with integer operations so the reduction is exact
+    const int64_t quarter = int64_t(90) << Fixed32::fractionBits;
+    int64_t angle = degrees.raw % (4 * quarter);
+    if (angle < 0)
+        angle += 4 * quarter;
+    int quadrant = static_cast<int>(angle / quarter);
+    int64_t offset = angle % quarter;
+    bool complement = offset > quarter / 2;
+    if (complement)
+        offset = quarter - offset;
+
+    // Taylor series up to x^12, the next term is below the resolution for x <= pi / 4
+    Fixed32 x = Fixed32::fromRaw(offset) * Fixed32::fromRaw(fixedRadiansPerDegree);
+    Fixed32 x2 = x * x;
+    Fixed32 s = Fixed32::fromRaw(fixedInverseFactorials[11]);
+    for (int n = 9; n >= 1; n -= 2)
+        s = Fixed32::fromRaw(fixedInverseFactorials[n]) - x2 * s;
+    s = s * x;
+    Fixed32 c = Fixed32::fromRaw(fixedInverseFactorials[12]);
+    for (int n = 10; n >= 0; n -= 2)
+        c = Fixed32::fromRaw(fixedInverseFactorials[n]) - x2 * c;
+    if (complement)
+        swap(s, c);
+
+    switch (quadrant)
+    {
+    case 0:
+        sine = s;
+        cosine = c;
+        break;
+    case 1:
+        sine = c;
+        cosine = -s;
+        break;
+    case 2:
+        sine = -s;
+        cosine = -c;
+        break;
+    default:
+        sine = -c;
+        cosine = s;
+        break;
+    }
+}
+
+BasicAffineMatrix<Fixed32> rotationMatrix(Fixed32 degrees)
+{
+    Fixed32 sine, cosine;
+    sinCosDegrees(degrees, sine, cosine);
+
+    BasicAffineMatrix<Fixed32> m;
+    m.a = cosine;
+    m.b = -sine;
+    m.c = sine;
+    m.d = cosine;
+    return m;
+}
@@ -0,0 +1,27 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: RotationCache.h
+
+Description: Rotation matrices for angles in degrees. The sine and cosine are computed once per
+rotation instead of once per vertex, and whole degree angles come from a table built once: the
+multiples of 90 degrees are exactly 0, 1 and -1, the multiples of 15 degrees use their closed
+forms, so common angles compose without any rounding error from the conversion to radians.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "AffineMatrix.h"
+
+// Sine and cosine of an angle in degrees, both computed together
+void sinCosDegrees(double degrees, double& sine, double& cosine);
+
+// Counterclockwise rotation matrix around the origin for an angle in degrees, in double precision
+AffineMatrixD rotationMatrix(double degrees);
+
+// Sine and cosine of an angle in degrees computed with fixed point operations only, so they are the
+// same on every machine. The multiples of 90 degrees are exactly 0, 1 and -1
+void sinCosDegrees(Fixed32 degrees, Fixed32& sine, Fixed32& cosine);
+
+// Counterclockwise rotation matrix around the origin for an angle in degrees, in fixed point
+BasicAffineMatrix<Fixed32> rotationMatrix(Fixed32 degrees);
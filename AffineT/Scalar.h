@@ -0,0 +1,42 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: Scalar.h
+
+Description: Scalar type the vertices are transformed in, chosen when building the program, so
+there is no runtime dispatch on it:
+
+    default                 float    fastest, the SIMD kernels are used
+    AFFINET_SCALAR_DOUBLE   double   each vertex is transformed in double and rounded once to float
+    AFFINET_SCALAR_FIXED    Fixed32  32.32 fixed point, the same bits on every machine
+
+The ReleaseDouble and ReleaseFixed configurations of the projects define the two macros.
+
+The vertices are stored and drawn as floats whatever the choice, only the arithmetic of the
+transformation changes. The float and double builds compose the transformations in double. The
+fixed point build composes them in fixed point too, with a sine and cosine computed in fixed point,
+so the composed matrix and the transformed vertices do not depend on the math library or on how
+the compiler contracts floating point operations.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "Fixed32.h"
+
+#if defined(AFFINET_SCALAR_DOUBLE) && defined(AFFINET_SCALAR_FIXED)
+#error "Only one of AFFINET_SCALAR_DOUBLE and AFFINET_SCALAR_FIXED can be defined"
+#endif
+
+#if defined(AFFINET_SCALAR_DOUBLE)
+typedef double Scalar;
+typedef double JournalScalar;
+const char* const scalarName = "double";
+#elif defined(AFFINET_SCALAR_FIXED)
+typedef Fixed32 Scalar;
+typedef Fixed32 JournalScalar;
+const char* const scalarName = "fixed 32.32";
+#else
+typedef float Scalar;
+typedef double JournalScalar;
+const char* const scalarName = "float";
+#endif
@@ -0,0 +1,155 @@
+#include "SceneGraph.h"
+#include "TransformKernel.h"
+#include <utility>
+using namespace std;
+
+namespace
+{
+    bool sameMatrix(const JournalMatrix& lhs, const JournalMatrix& rhs)
+    {
+        return lhs.a == rhs.a && lhs.b == rhs.b && lhs.tx == rhs.tx &&
+               lhs.c == rhs.c && lhs.d == rhs.d && lhs.ty == rhs.ty;
+    }
+}
+
+SceneGraph::SceneGraph() :
+    m_dirty(false)
+{
+    addNode(root, false, VertexStore());
+}
+
+SceneGraph::NodeId SceneGraph::addGroup(NodeId parent)
+{
+    return addNode(parent, false, VertexStore());
+}
+
+SceneGraph::NodeId SceneGraph::addShape(NodeId parent, VertexStore vertices)
+{
+    return addNode(parent, true, move(vertices));
+}
+
+// A new node is appended after its parent, which keeps every parent before its children in the array
+SceneGraph::NodeId SceneGraph::addNode(NodeId parent, bool hasGeometry, VertexStore vertices)
+{
+    Node node;
+    node.parent = parent;
+    node.dirty = true;
+    node.added = true;
+    node.hasGeometry = hasGeometry;
+    node.transformed = vertices;
+    node.original = move(vertices);
+    m_nodes.push_back(move(node));
+    m_worldChanged.push_back(0);
+    m_dirty = true;
+    return m_nodes.size() - 1;
+}
+
+size_t SceneGraph::nodeCount() const
+{
+    return m_nodes.size();
+}
+
+SceneGraph::NodeId SceneGraph::parent(NodeId node) const
+{
+    return m_nodes[node].parent;
+}
+
+bool SceneGraph::hasGeometry(NodeId node) const
+{
+    return m_nodes[node].hasGeometry;
+}
+
+void SceneGraph::setLocal(NodeId node, const JournalMatrix& local)
+{
+    m_nodes[node].local = local;
+    m_nodes[node].dirty = true;
+    m_dirty = true;
+}
+
+void SceneGraph::append(NodeId node, const JournalMatrix& transformation)
+{
+    setLocal(node, transformation * m_nodes[node].local);
+}
+
+// The children come after their parent in the array, so only the nodes after it are visited
+void SceneGraph::pushToChildren(NodeId node)
+{
+    if (sameMatrix(m_nodes[node].local, JournalMatrix()))
+    {
+        return;
+    }
+    for (NodeId id = node + 1; id < m_nodes.size(); ++id)
+    {
+        if (m_nodes[id].parent == node)
+        {
+            setLocal(id, m_nodes[node].local * m_nodes[id].local);
+        }
+    }
+    setLocal(node, JournalMatrix());
+}
+
+const JournalMatrix& SceneGraph::local(NodeId node) const
+{
+    return m_nodes[node].local;
+}
+
+const JournalMatrix& SceneGraph::world(NodeId node) const
+{
+    return m_nodes[node].world;
+}
+
+bool SceneGraph::update()
+{
+    m_changedShapes.clear();
+    if (!m_dirty)
+    {
+        return false;
+    }
+
+    // Only the flags are visited for the clean nodes, the matrices of a subtree are recomputed when its
+    // root was edited and the vertices only when the resulting world matrix is different
+    for (NodeId id = 0; id < m_nodes.size(); ++id)
+    {
+        Node& node = m_nodes[id];
+        bool parentChanged = id != root && m_worldChanged[node.parent];
+        m_worldChanged[id] = 0;
+        if (!node.dirty && !parentChanged)
+        {
+            continue;
+        }
+
+        JournalMatrix world = id == root ? node.local : m_nodes[node.parent].world * node.local;
+        bool added = node.added;
+        node.dirty = false;
+        node.added = false;
+        if (sameMatrix(world, node.world) && !added)
+        {
+            continue;
+        }
+
+        node.world = world;
+        m_worldChanged[id] = 1;
+        if (node.hasGeometry)
+        {
+            transformVertices(world.cast<Scalar>(), node.original.x(), node.original.y(), node.transformed.x(), node.transformed.y(), node.original.size());
+            m_changedShapes.push_back(id);
+        }
+    }
+    m_dirty = false;
+    return !m_changedShapes.empty();
+}
+
+const vector<SceneGraph::NodeId>& SceneGraph::changedShapes() const
+{
+    return m_changedShapes;
+}
+
+const VertexStore& SceneGraph::original(NodeId node) const
+{
+    return m_nodes[node].original;
+}
+
+const VertexStore& SceneGraph::vertices(NodeId node) const
+{
+    return m_nodes[node].transformed;
+}
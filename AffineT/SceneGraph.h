@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: SceneGraph.h
+
+Description: Hierarchy of nodes carrying local affine matrices, used to move assemblies of shapes
+together. The world matrix of each node (its parent's world matrix times its local matrix) is cached
+and only recomputed for the nodes whose local matrix or one of whose ancestors changed, and the
+vertices of a shape are only transformed again when its world matrix actually changed.
+The nodes are stored in a flat array where every parent comes before its children, so an update is
+a single pass over the array without recursion.
+The matrices are composed in the precision of the transformation journal (see Scalar.h) and each
+world matrix is converted once to the scalar type of the build to transform the vertices. The batch
+mode uses it to move the parts of an assembly, see runAssembly.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "AffineMatrix.h"
+#include "VertexStore.h"
+#include <cstddef>
+#include <vector>
+
+class SceneGraph
+{
+public:
+    typedef std::size_t NodeId;
+
+    // The root node always exists, its local matrix places the whole scene
+    static const NodeId root = 0;
+
+    SceneGraph();
+
+    // Function to add an empty node grouping its future children, returns its id
+    NodeId addGroup(NodeId parent);
+
+    // Function to add a node with geometry, returns its id. Shapes can have children too
+    NodeId addShape(NodeId parent, VertexStore vertices);
+
+    std::size_t nodeCount() const;
+    NodeId parent(NodeId node) const;
+    bool hasGeometry(NodeId node) const;
+
+    // Replace the local matrix of a node, its subtree is updated on the next call to update
+    void setLocal(NodeId node, const JournalMatrix& local);
+
+    // Append a transformation to the local matrix of a node, it is applied after the previous ones
+    void append(NodeId node, const JournalMatrix& transformation);
+
+    // Move the local matrix of a node into the local matrices of its children, the node is left with the
+    // identity. The world matrices stay the same, so a transformation appended to a child afterwards is
+    // applied after everything the node applied so far
+    void pushToChildren(NodeId node);
+
+    const JournalMatrix& local(NodeId node) const;
+
+    // World matrix as of the last update
+    const JournalMatrix& world(NodeId node) const;
+
+    // Recompute the world matrices of the changed subtrees and transform the vertices of the shapes
+    // whose world matrix changed. Returns true if any shape changed
+    bool update();
+
+    // Shapes transformed by the last update, in increasing id order
+    const std::vector<NodeId>& changedShapes() const;
+
+    // Vertices of a shape before and after its world matrix, as of the last update
+    const VertexStore& original(NodeId node) const;
+    const VertexStore& vertices(NodeId node) const;
+
+private:
+    struct Node
+    {
+        NodeId parent;
+        JournalMatrix local;
+        JournalMatrix world;
+        bool dirty;
+        bool added; // Reported as changed by the first update even if its world matrix is the identity
+        bool hasGeometry;
+        VertexStore original;
+        VertexStore transformed;
+    };
+
+    NodeId addNode(NodeId parent, bool hasGeometry, VertexStore vertices);
+
+    std::vector<Node> m_nodes;
+    std::vector<NodeId> m_changedShapes;
+
+    // Per node flag set during an update when the world matrix changed, so the children follow
+    std::vector<char> m_worldChanged;
+    bool m_dirty;
+};
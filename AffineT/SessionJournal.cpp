@@ -0,0 +1,249 @@
+#include "SessionJournal.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <cstring>
+using namespace std;
+
+namespace
+{
+    const char journalMagic[8] = { 'A', 'F', 'F', 'I', 'N', 'E', 'T', 'J' };
+    const uint32_t journalVersion = 1;
+
+    const char vertexTag = 'V';
+    const char transformTag = 'T';
+    const char undoTag = 'U';
+    const char redoTag = 'R';
+    const char jumpTag = 'J';
+
+    template <typename T>
+    void append(vector<char>& bytes, const T& value)
+    {
+        const char* data = reinterpret_cast<const char*>(&value);
+        bytes.insert(bytes.end(), data, data + sizeof(T));
+    }
+
+    // Sequential reader over the mapped journal, every read fails past the end of the file
+    class RecordReader
+    {
+    public:
+        RecordReader(const char* data, size_t size) :
+            m_position(data),
+            m_end(data + size)
+        {
+        }
+
+        bool atEnd() const
+        {
+            return m_position == m_end;
+        }
+
+        size_t remaining() const
+        {
+            return static_cast<size_t>(m_end - m_position);
+        }
+
+        template <typename T>
+        bool read(T& value)
+        {
+            return readBytes(&value, sizeof(T));
+        }
+
+        bool readBytes(void* output, size_t size)
+        {
+            if (remaining() < size)
+                return false;
+            memcpy(output, m_position, size);
+            m_position += size;
+            return true;
+        }
+
+    private:
+        const char* m_position;
+        const char* m_end;
+    };
+}
+
+SessionRecorder::SessionRecorder() :
+    m_file(nullptr)
+{
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    close();
+}
+
+bool SessionRecorder::open(const string& path, string& error)
+{
+    m_file = fopen(path.c_str(), "wb");
+    if (!m_file)
+    {
+        error = "Could not open " + path + " for writing";
+        return false;
+    }
+
+    vector<char> header(journalMagic, journalMagic + sizeof(journalMagic));
+    append(header, journalVersion);
+    if (!write(header))
+    {
+        error = "Could not write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool SessionRecorder::isOpen() const
+{
+    return m_file != nullptr;
+}
+
+void SessionRecorder::close()
+{
+    if (m_file)
+    {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool SessionRecorder::recordVertices(const VertexStore& vertices)
+{
+    vector<char> bytes;
+    bytes.reserve(1 + sizeof(uint64_t) + vertices.size() * 2 * sizeof(float));
+    bytes.push_back(vertexTag);
+    append(bytes, static_cast<uint64_t>(vertices.size()));
+    const char* x = reinterpret_cast<const char*>(vertices.x());
+    const char* y = reinterpret_cast<const char*>(vertices.y());
+    bytes.insert(bytes.end(), x, x + vertices.size() * sizeof(float));
+    bytes.insert(bytes.end(), y, y + vertices.size() * sizeof(float));
+    return write(bytes);
+}
+
+bool SessionRecorder::record(const InputMessage& message)
+{
+    vector<char> bytes;
+    switch (message.action)
+    {
+    case InputAction::Transform:
+        bytes.push_back(transformTag);
+        append(bytes, static_cast<uint8_t>(message.command.type));
+        append(bytes, message.command.x);
+        append(bytes, message.command.y);
+        break;
+    case InputAction::Undo:
+        bytes.push_back(undoTag);
+        break;
+    case InputAction::Redo:
+        bytes.push_back(redoTag);
+        break;
+    case InputAction::JumpTo:
+        bytes.push_back(jumpTag);
+        append(bytes, static_cast<uint64_t>(message.step));
+        break;
+    default:
+        // The end of the session is the end of the file
+        return true;
+    }
+    return write(bytes);
+}
+
+// Each record is flushed right away so the journal survives a crash of the program
+bool SessionRecorder::write(const vector<char>& bytes)
+{
+    if (!m_file)
+    {
+        return false;
+    }
+    return fwrite(bytes.data(), 1, bytes.size(), m_file) == bytes.size() && fflush(m_file) == 0;
+}
+
+bool loadSessionJournal(const string& path, VertexStore& vertices, vector<InputMessage>& messages, string& error)
+{
+    MappedFile file;
+    if (!file.open(path, error))
+    {
+        return false;
+    }
+
+    RecordReader reader(file.data(), file.size());
+    char magic[sizeof(journalMagic)];
+    uint32_t version;
+    if (!reader.readBytes(magic, sizeof(magic)) || memcmp(magic, journalMagic, sizeof(magic)) != 0 ||
+        !reader.read(version))
+    {
+        error = path + " is not a session journal";
+        return false;
+    }
+    if (version != journalVersion)
+    {
+        error = path + ": unsupported journal version " + to_string(version);
+        return false;
+    }
+
+    bool hasVertices = false;
+    messages.clear();
+    while (!reader.atEnd())
+    {
+        char tag;
+        reader.read(tag);
+        if (tag == vertexTag)
+        {
+            uint64_t count;
+            if (!reader.read(count) || count > reader.remaining() / (2 * sizeof(float)))
+                break;
+            if (hasVertices)
+            {
+                error = path + ": the journal holds more than one shape";
+                return false;
+            }
+            vertices.resize(static_cast<size_t>(count));
+            reader.readBytes(vertices.x(), vertices.size() * sizeof(float));
+            reader.readBytes(vertices.y(), vertices.size() * sizeof(float));
+            hasVertices = true;
+            continue;
+        }
+
+        InputMessage message = { InputAction::Transform, TransformCommand(), 0 };
+        if (tag == transformTag)
+        {
+            uint8_t type;
+            if (!reader.read(type) || !reader.read(message.command.x) || !reader.read(message.command.y))
+                break;
+            if (type > static_cast<uint8_t>(TransformType::Shearing))
+            {
+                error = path + ": unknown transformation type " + to_string(type);
+                return false;
+            }
+            message.command.type = static_cast<TransformType>(type);
+        }
+        else if (tag == undoTag)
+        {
+            message.action = InputAction::Undo;
+        }
+        else if (tag == redoTag)
+        {
+            message.action = InputAction::Redo;
+        }
+        else if (tag == jumpTag)
+        {
+            uint64_t step;
+            if (!reader.read(step))
+                break;
+            message.action = InputAction::JumpTo;
+            message.step = static_cast<size_t>(step);
+        }
+        else
+        {
+            error = path + ": unknown record '" + string(1, tag) + "'";
+            return false;
+        }
+        messages.push_back(message);
+    }
+
+    if (!hasVertices || vertices.size() < 3)
+    {
+        error = path + " does not hold a shape of at least 3 vertices";
+        return false;
+    }
+    return true;
+}
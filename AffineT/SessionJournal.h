@@ -0,0 +1,72 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: SessionJournal.h
+
+Description: Append-only binary journal of an interactive session: the vertices of the shape and
+every action chosen in the console, in order. Each record is written and flushed as soon as it
+happens, so a journal stays readable up to the last complete record even if the program is killed.
+The replay mode loads a journal and executes it again without a window.
+
+Format: the 8 bytes "AFFINETJ" and a 32-bit version, then one record per entry, each starting with
+a one byte tag:
+    'V' count (64 bits), count x floats, count y floats     vertices of the shape
+    'T' type (8 bits), x float, y float                     transformation
+    'U' and 'R'                                             undo and redo
+    'J' step (64 bits)                                      go to step
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "TransformScript.h"
+#include "VertexStore.h"
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Actions the user can choose from the console
+enum class InputAction
+{
+    Transform,
+    Undo,
+    Redo,
+    JumpTo,
+    Exit
+};
+
+// Message sent from the input thread to the render loop, it is also what the journal records
+struct InputMessage
+{
+    InputAction action;
+    TransformCommand command;
+    std::size_t step;
+};
+
+class SessionRecorder
+{
+public:
+    SessionRecorder();
+    ~SessionRecorder();
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    // Function to create the journal file. On failure the error message is set and false is returned
+    bool open(const std::string& path, std::string& error);
+
+    bool isOpen() const;
+    void close();
+
+    // Functions to append a record, they return false if it could not be written
+    bool recordVertices(const VertexStore& vertices);
+    bool record(const InputMessage& message);
+
+private:
+    bool write(const std::vector<char>& bytes);
+
+    FILE* m_file;
+};
+
+// Function to load a whole journal. A record cut at the end of the file is ignored
+bool loadSessionJournal(const std::string& path, VertexStore& vertices, std::vector<InputMessage>& messages, std::string& error);
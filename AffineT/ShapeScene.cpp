@@ -0,0 +1,234 @@
+#include "ShapeScene.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+namespace
+{
+    // Unit normal of the edge from p1 to p2
+    sf::Vector2f edgeNormal(const sf::Vector2f& p1, const sf::Vector2f& p2)
+    {
+        sf::Vector2f normal(p1.y - p2.y, p2.x - p1.x);
+        float length = sqrt(normal.x * normal.x + normal.y * normal.y);
+        if (length != 0)
+            normal /= length;
+        return normal;
+    }
+}
+
+// One triangle per edge for the fill, all sharing the centroid, and two per edge for the outline
+size_t ShapeScene::ShapeRange::fillCount() const
+{
+    return points * 3;
+}
+
+size_t ShapeScene::ShapeRange::outlineCount() const
+{
+    return outlineThickness > 0 ? points * 6 : 0;
+}
+
+ShapeScene::ShapeScene() :
+    m_triangles(sf::Triangles),
+    m_buffer(sf::Triangles, sf::VertexBuffer::Dynamic),
+    m_dirtyBegin(0),
+    m_dirtyEnd(0),
+    m_useBuffer(false),
+    m_changed(true)
+{
+}
+
+size_t ShapeScene::addShape(const VertexStore& vertices, sf::Color color, sf::Color outlineColor, float outlineThickness)
+{
+    ShapeRange range;
+    range.first = m_triangles.getVertexCount();
+    range.points = vertices.size();
+    range.outlineThickness = outlineThickness;
+    m_triangles.resize(range.first + range.fillCount() + range.outlineCount());
+    m_shapes.push_back(range);
+
+    size_t index = m_shapes.size() - 1;
+    setColor(index, color);
+    setOutlineColor(index, outlineColor);
+    updateShape(index, vertices);
+    return index;
+}
+
+void ShapeScene::updateShape(size_t index, const VertexStore& vertices)
+{
+    updateShape(index, vertices.x(), vertices.y(), vertices.size());
+}
+
+void ShapeScene::updateShape(size_t index, const float* x, const float* y, size_t count)
+{
+    TraceZone zone("rebuild shape");
+    const ShapeRange& range = m_shapes[index];
+    if (count != range.points || count == 0)
+    {
+        return;
+    }
+
+    sf::Vector2f centroid;
+    for (size_t i = 0; i < count; ++i)
+    {
+        centroid += sf::Vector2f(x[i], y[i]);
+    }
+    centroid /= static_cast<float>(count);
+
+    sf::Vertex* fill = &m_triangles[range.first];
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t next = i + 1 < count ? i + 1 : 0;
+        fill[i * 3].position = centroid;
+        fill[i * 3 + 1].position = sf::Vector2f(x[i], y[i]);
+        fill[i * 3 + 2].position = sf::Vector2f(x[next], y[next]);
+    }
+
+    if (range.outlineCount() > 0)
+    {
+        // Each point is pushed outwards along the mean of the normals of its two edges, scaled so that
+        // both edges keep the same thickness (a miter join, like sf::Shape)
+        sf::Vertex* outline = fill + range.fillCount();
+        sf::Vector2f previousOuter;
+        sf::Vector2f firstOuter;
+        for (size_t i = 0; i <= count; ++i)
+        {
+            size_t current = i < count ? i : 0;
+            size_t previous = current > 0 ? current - 1 : count - 1;
+            size_t next = current + 1 < count ? current + 1 : 0;
+            sf::Vector2f p0(x[previous], y[previous]);
+            sf::Vector2f p1(x[current], y[current]);
+            sf::Vector2f p2(x[next], y[next]);
+
+            sf::Vector2f n1 = edgeNormal(p0, p1);
+            sf::Vector2f n2 = edgeNormal(p1, p2);
+            sf::Vector2f toCenter = centroid - p1;
+            if (n1.x * toCenter.x + n1.y * toCenter.y > 0)
+                n1 = -n1;
+            if (n2.x * toCenter.x + n2.y * toCenter.y > 0)
+                n2 = -n2;
+            float factor = 1 + (n1.x * n2.x + n1.y * n2.y);
+            sf::Vector2f normal = factor != 0 ? (n1 + n2) / factor : n1;
+            sf::Vector2f outer = i < count ? p1 + normal * range.outlineThickness : firstOuter;
+
+            if (i == 0)
+            {
+                firstOuter = outer;
+            }
+            else
+            {
+                sf::Vertex* quad = &outline[(i - 1) * 6];
+                quad[0].position = p0;
+                quad[1].position = previousOuter;
+                quad[2].position = p1;
+                quad[3].position = previousOuter;
+                quad[4].position = outer;
+                quad[5].position = p1;
+            }
+            previousOuter = outer;
+        }
+    }
+    markDirty(range.first, range.fillCount() + range.outlineCount());
+}
+
+void ShapeScene::setColor(size_t index, sf::Color color)
+{
+    const ShapeRange& range = m_shapes[index];
+    setRangeColor(range.first, range.fillCount(), color);
+}
+
+void ShapeScene::setOutlineColor(size_t index, sf::Color color)
+{
+    const ShapeRange& range = m_shapes[index];
+    setRangeColor(range.first + range.fillCount(), range.outlineCount(), color);
+}
+
+size_t ShapeScene::shapeCount() const
+{
+    return m_shapes.size();
+}
+
+void ShapeScene::setView(const sf::Transform& view)
+{
+    // The view is applied when drawing, the triangles do not have to be uploaded again
+    if (!equal(view.getMatrix(), view.getMatrix() + 16, m_view.getMatrix()))
+    {
+        m_view = view;
+        m_changed = true;
+    }
+}
+
+const sf::Transform& ShapeScene::getView() const
+{
+    return m_view;
+}
+
+bool ShapeScene::update()
+{
+    size_t vertexCount = m_triangles.getVertexCount();
+    if (m_dirtyBegin < m_dirtyEnd && vertexCount > 0)
+    {
+        TraceZone zone("upload shapes");
+
+        // The whole buffer is recreated when shapes were added, otherwise only the changed range is sent
+        if (m_buffer.getVertexCount() != vertexCount)
+        {
+            m_useBuffer = sf::VertexBuffer::isAvailable() &&
+                          m_buffer.create(vertexCount) &&
+                          m_buffer.update(&m_triangles[0]);
+        }
+        else if (m_useBuffer)
+        {
+            m_useBuffer = m_buffer.update(&m_triangles[m_dirtyBegin], m_dirtyEnd - m_dirtyBegin,
+                                          static_cast<unsigned int>(m_dirtyBegin));
+        }
+    }
+    m_dirtyBegin = m_dirtyEnd = 0;
+
+    bool changed = m_changed;
+    m_changed = false;
+    return changed;
+}
+
+const sf::VertexArray& ShapeScene::getTriangles() const
+{
+    return m_triangles;
+}
+
+void ShapeScene::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    states.transform *= m_view;
+    if (m_useBuffer)
+        target.draw(m_buffer, states);
+    else
+        target.draw(m_triangles, states);
+}
+
+void ShapeScene::setRangeColor(size_t first, size_t count, sf::Color color)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    for (size_t i = first; i < first + count; ++i)
+    {
+        m_triangles[i].color = color;
+    }
+    markDirty(first, count);
+}
+
+// The changed shapes are tracked as a single range, shapes edited together are usually close to each other
+void ShapeScene::markDirty(size_t first, size_t count)
+{
+    if (m_dirtyBegin == m_dirtyEnd)
+    {
+        m_dirtyBegin = first;
+        m_dirtyEnd = first + count;
+    }
+    else
+    {
+        m_dirtyBegin = min(m_dirtyBegin, first);
+        m_dirtyEnd = max(m_dirtyEnd, first + count);
+    }
+    m_changed = true;
+}
@@ -0,0 +1,79 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: ShapeScene.h
+
+Description: Filled polygons packed together in a single triangle list, so any number of shapes
+is drawn with one draw call instead of one per shape. Each polygon is split in a fan of triangles
+around its centroid and keeps its own color, with an optional outline made of one quad per edge.
+Unlike sf::Shape, whose fill and outline are recomputed on every setPoint, all the points of a
+shape are replaced at once and its fill and outline are rebuilt in a single pass.
+The vertices stay in Cartesian coordinates and the view transform maps them to the screen when
+drawing. The triangles are mirrored in a vertex buffer when it is available, and only the shapes
+changed since the last update are uploaded again.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "VertexStore.h"
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <vector>
+
+class ShapeScene : public sf::Drawable
+{
+public:
+    ShapeScene();
+
+    // Function to add a polygon of at least 3 vertices, returns the index of the shape
+    // The outline thickness is in Cartesian units, the shape has no outline when it is 0
+    std::size_t addShape(const VertexStore& vertices, sf::Color color,
+                         sf::Color outlineColor = sf::Color::Transparent, float outlineThickness = 0);
+
+    // Move all the points of a shape, the number of vertices has to stay the same
+    void updateShape(std::size_t index, const VertexStore& vertices);
+    void updateShape(std::size_t index, const float* x, const float* y, std::size_t count);
+
+    void setColor(std::size_t index, sf::Color color);
+    void setOutlineColor(std::size_t index, sf::Color color);
+
+    std::size_t shapeCount() const;
+
+    // Transform from the Cartesian coordinates of the shapes to the screen
+    void setView(const sf::Transform& view);
+    const sf::Transform& getView() const;
+
+    // Upload the shapes changed since the last call to the vertex buffer
+    // Returns true if the scene changed and has to be drawn again
+    bool update();
+
+    // All the shapes as one triangle list, in Cartesian coordinates
+    const sf::VertexArray& getTriangles() const;
+
+private:
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+
+    // Range of the triangle list used by one shape, the fill comes first and then the outline
+    struct ShapeRange
+    {
+        std::size_t first;
+        std::size_t points;
+        float outlineThickness;
+
+        std::size_t fillCount() const;
+        std::size_t outlineCount() const;
+    };
+
+    void setRangeColor(std::size_t first, std::size_t count, sf::Color color);
+
+    void markDirty(std::size_t first, std::size_t count);
+
+    std::vector<ShapeRange> m_shapes;
+    sf::VertexArray m_triangles;
+    sf::VertexBuffer m_buffer;
+    sf::Transform m_view;
+    std::size_t m_dirtyBegin;
+    std::size_t m_dirtyEnd;
+    bool m_useBuffer;
+    bool m_changed;
+};
@@ -0,0 +1,246 @@
+#include "SoftwareRenderTarget.h"
+#include <SFML/Graphics/Image.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+using namespace std;
+
+namespace
+{
+    // Twice the signed area of the triangle (a, b, p), positive when p is on the left of a->b
+    float edgeFunction(const sf::Vector2f& a, const sf::Vector2f& b, float px, float py)
+    {
+        return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+    }
+
+    bool isFinite(const sf::Vector2f& p)
+    {
+        return isfinite(p.x) && isfinite(p.y);
+    }
+
+    // Function to clip the segment from -> to to the rectangle [0, width] x [0, height] (Liang-Barsky).
+    // The ends are clamped to the rectangle afterwards, the rounding of far away ends could leave them out.
+    // Returns false if the segment does not cross the rectangle
+    bool clipSegment(sf::Vector2f& from, sf::Vector2f& to, float width, float height)
+    {
+        float dx = to.x - from.x;
+        float dy = to.y - from.y;
+        if (!isfinite(dx) || !isfinite(dy))
+            return false;
+        const float p[4] = { -dx, dx, -dy, dy };
+        const float q[4] = { from.x, width - from.x, from.y, height - from.y };
+        float t0 = 0;
+        float t1 = 1;
+        for (int i = 0; i < 4; ++i)
+        {
+            if (p[i] == 0)
+            {
+                if (q[i] < 0)
+                    return false;
+            }
+            else if (p[i] < 0)
+                t0 = max(t0, q[i] / p[i]);
+            else
+                t1 = min(t1, q[i] / p[i]);
+        }
+        if (t0 > t1)
+            return false;
+
+        sf::Vector2f start(from.x + t0 * dx, from.y + t0 * dy);
+        sf::Vector2f end(from.x + t1 * dx, from.y + t1 * dy);
+        from = sf::Vector2f(min(max(start.x, 0.0f), width), min(max(start.y, 0.0f), height));
+        to = sf::Vector2f(min(max(end.x, 0.0f), width), min(max(end.y, 0.0f), height));
+        return true;
+    }
+
+    bool hasExtension(const string& path, const string& extension)
+    {
+        if (path.size() < extension.size())
+            return false;
+        string end = path.substr(path.size() - extension.size());
+        transform(end.begin(), end.end(), end.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        return end == extension;
+    }
+}
+
+SoftwareRenderTarget::SoftwareRenderTarget(unsigned int width, unsigned int height) :
+    m_width(width),
+    m_height(height),
+    m_pixels(static_cast<size_t>(width) * height * 4)
+{
+    clear();
+}
+
+void SoftwareRenderTarget::clear(const sf::Color& color)
+{
+    for (size_t i = 0; i < m_pixels.size(); i += 4)
+    {
+        m_pixels[i] = color.r;
+        m_pixels[i + 1] = color.g;
+        m_pixels[i + 2] = color.b;
+        m_pixels[i + 3] = color.a;
+    }
+}
+
+void SoftwareRenderTarget::draw(const sf::VertexArray& vertices, const sf::Transform& transform)
+{
+    size_t count = vertices.getVertexCount();
+    auto position = [&](size_t i) { return transform.transformPoint(vertices[i].position); };
+    switch (vertices.getPrimitiveType())
+    {
+    case sf::Lines:
+        for (size_t i = 0; i + 1 < count; i += 2)
+            drawLine(position(i), position(i + 1), vertices[i].color);
+        break;
+    case sf::LineStrip:
+        for (size_t i = 0; i + 1 < count; ++i)
+            drawLine(position(i), position(i + 1), vertices[i].color);
+        break;
+    case sf::Triangles:
+        for (size_t i = 0; i + 2 < count; i += 3)
+            fillTriangle(position(i), position(i + 1), position(i + 2), vertices[i].color);
+        break;
+    case sf::TriangleStrip:
+        for (size_t i = 0; i + 2 < count; ++i)
+            fillTriangle(position(i), position(i + 1), position(i + 2), vertices[i].color);
+        break;
+    case sf::TriangleFan:
+        for (size_t i = 1; i + 1 < count; ++i)
+            fillTriangle(position(0), position(i), position(i + 1), vertices[0].color);
+        break;
+    default:
+        break;
+    }
+}
+
+unsigned int SoftwareRenderTarget::getWidth() const
+{
+    return m_width;
+}
+
+unsigned int SoftwareRenderTarget::getHeight() const
+{
+    return m_height;
+}
+
+const vector<sf::Uint8>& SoftwareRenderTarget::getPixels() const
+{
+    return m_pixels;
+}
+
+bool SoftwareRenderTarget::saveToFile(const string& path) const
+{
+    if (hasExtension(path, ".ppm"))
+        return savePPM(path);
+
+    sf::Image image;
+    image.create(m_width, m_height, m_pixels.data());
+    return image.saveToFile(path);
+}
+
+// Lines are stepped one pixel at a time along their longest axis (DDA)
+// The segment is clipped to the image first, so the number of steps is bounded by its size
+void SoftwareRenderTarget::drawLine(sf::Vector2f from, sf::Vector2f to, const sf::Color& color)
+{
+    if (!isFinite(from) || !isFinite(to) || !clipSegment(from, to, static_cast<float>(m_width), static_cast<float>(m_height)))
+        return;
+
+    float dx = to.x - from.x;
+    float dy = to.y - from.y;
+    int steps = static_cast<int>(ceil(max(abs(dx), abs(dy))));
+    if (steps == 0)
+    {
+        setPixel(static_cast<int>(floor(from.x)), static_cast<int>(floor(from.y)), color);
+        return;
+    }
+
+    float stepX = dx / steps;
+    float stepY = dy / steps;
+    for (int i = 0; i <= steps; ++i)
+    {
+        setPixel(static_cast<int>(floor(from.x + stepX * i)), static_cast<int>(floor(from.y + stepY * i)), color);
+    }
+}
+
+// A pixel is filled when its center is inside the triangle, edge functions are stepped incrementally
+// The bounding box is clamped to the image in float, the coordinates can be far beyond the range of int
+void SoftwareRenderTarget::fillTriangle(const sf::Vector2f& a, const sf::Vector2f& b, const sf::Vector2f& c, const sf::Color& color)
+{
+    if (!isFinite(a) || !isFinite(b) || !isFinite(c))
+        return;
+    float area = edgeFunction(a, b, c.x, c.y);
+    if (area == 0 || !isfinite(area))
+        return;
+
+    // Order the vertices so that the inside is where all edge functions are positive
+    const sf::Vector2f& p1 = area > 0 ? b : c;
+    const sf::Vector2f& p2 = area > 0 ? c : b;
+
+    float left = max(0.0f, floor(min({ a.x, b.x, c.x })));
+    float top = max(0.0f, floor(min({ a.y, b.y, c.y })));
+    float right = min(static_cast<float>(m_width) - 1, ceil(max({ a.x, b.x, c.x })));
+    float bottom = min(static_cast<float>(m_height) - 1, ceil(max({ a.y, b.y, c.y })));
+    if (left > right || top > bottom)
+        return;
+    int minX = static_cast<int>(left);
+    int minY = static_cast<int>(top);
+    int maxX = static_cast<int>(right);
+    int maxY = static_cast<int>(bottom);
+
+    float startX = minX + 0.5f;
+    for (int y = minY; y <= maxY; ++y)
+    {
+        float py = y + 0.5f;
+        float w0 = edgeFunction(p1, p2, startX, py);
+        float w1 = edgeFunction(p2, a, startX, py);
+        float w2 = edgeFunction(a, p1, startX, py);
+        float step0 = -(p2.y - p1.y);
+        float step1 = -(a.y - p2.y);
+        float step2 = -(p1.y - a.y);
+        sf::Uint8* pixel = &m_pixels[(static_cast<size_t>(y) * m_width + minX) * 4];
+        for (int x = minX; x <= maxX; ++x, pixel += 4)
+        {
+            if (w0 >= 0 && w1 >= 0 && w2 >= 0)
+            {
+                pixel[0] = color.r;
+                pixel[1] = color.g;
+                pixel[2] = color.b;
+                pixel[3] = color.a;
+            }
+            w0 += step0;
+            w1 += step1;
+            w2 += step2;
+        }
+    }
+}
+
+void SoftwareRenderTarget::setPixel(int x, int y, const sf::Color& color)
+{
+    if (x < 0 || y < 0 || x >= static_cast<int>(m_width) || y >= static_cast<int>(m_height))
+        return;
+    sf::Uint8* pixel = &m_pixels[(static_cast<size_t>(y) * m_width + x) * 4];
+    pixel[0] = color.r;
+    pixel[1] = color.g;
+    pixel[2] = color.b;
+    pixel[3] = color.a;
+}
+
+bool SoftwareRenderTarget::savePPM(const string& path) const
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+
+    // Binary PPM only holds RGB, the alpha channel is dropped
+    vector<sf::Uint8> rgb(static_cast<size_t>(m_width) * m_height * 3);
+    for (size_t i = 0, j = 0; i < m_pixels.size(); i += 4, j += 3)
+    {
+        rgb[j] = m_pixels[i];
+        rgb[j + 1] = m_pixels[i + 1];
+        rgb[j + 2] = m_pixels[i + 2];
+    }
+    bool written = fprintf(file, "P6\n%u %u\n255\n", m_width, m_height) > 0 &&
+                   fwrite(rgb.data(), 1, rgb.size(), file) == rgb.size();
+    return fclose(file) == 0 && written;
+}
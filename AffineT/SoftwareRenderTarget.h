@@ -0,0 +1,50 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: SoftwareRenderTarget.h
+
+Description: CPU rasterizer drawing sf::VertexArray primitives into an in-memory framebuffer.
+It mirrors the window.clear/window.draw calls of the main loop so the coordinate system and the
+shapes can be rendered to an image file on machines without a display or a GPU.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Transform.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+#include <string>
+#include <vector>
+
+class SoftwareRenderTarget
+{
+public:
+    SoftwareRenderTarget(unsigned int width, unsigned int height);
+
+    void clear(const sf::Color& color = sf::Color::Black);
+
+    // Lines, line strips, triangles, triangle strips and triangle fans are supported. Each primitive is
+    // drawn with the color of its first vertex. The transform is applied to the positions like the one of
+    // sf::RenderStates
+    void draw(const sf::VertexArray& vertices, const sf::Transform& transform = sf::Transform::Identity);
+
+    unsigned int getWidth() const;
+    unsigned int getHeight() const;
+
+    // RGBA pixels, row by row from the top left corner
+    const std::vector<sf::Uint8>& getPixels() const;
+
+    // Function to write the framebuffer to a file. PPM files are written directly, the other
+    // formats supported by sf::Image (png, bmp, tga, jpg) go through it
+    bool saveToFile(const std::string& path) const;
+
+private:
+    void drawLine(sf::Vector2f from, sf::Vector2f to, const sf::Color& color);
+    void fillTriangle(const sf::Vector2f& a, const sf::Vector2f& b, const sf::Vector2f& c, const sf::Color& color);
+    void setPixel(int x, int y, const sf::Color& color);
+    bool savePPM(const std::string& path) const;
+
+    unsigned int m_width;
+    unsigned int m_height;
+    std::vector<sf::Uint8> m_pixels;
+};
@@ -0,0 +1,55 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: SpscQueue.h
+
+Description: Fixed size lock-free queue for exactly one producer thread and one consumer thread.
+Used to pass the commands read from the console to the render loop without ever blocking it.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "The capacity must be a power of two");
+
+public:
+    SpscQueue() :
+        m_head(0),
+        m_tail(0)
+    {
+    }
+
+    // Called by the producer only. Returns false if the queue is full
+    bool push(const T& value)
+    {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+            return false;
+        m_items[tail & (Capacity - 1)] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Called by the consumer only. Returns false if the queue is empty
+    bool pop(T& value)
+    {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;
+        value = m_items[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // The indices only grow and wrap around together, each one lives on its own cache line so the
+    // producer and the consumer do not invalidate each other's line on every operation
+    alignas(64) std::atomic<std::size_t> m_head;
+    alignas(64) std::atomic<std::size_t> m_tail;
+    alignas(64) T m_items[Capacity];
+};
@@ -0,0 +1,153 @@
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <algorithm>
+using namespace std;
+
+// State of one parallelFor call, it lives on the stack of the calling thread
+struct ThreadPool::Loop
+{
+    const RangeTask* task;
+    atomic<size_t> remaining;
+    mutex doneMutex;
+    condition_variable done;
+};
+
+ThreadPool::ThreadPool(unsigned int workerCount) :
+    m_queued(0),
+    m_stop(false)
+{
+    for (unsigned int i = 0; i < workerCount; ++i)
+        m_queues.push_back(unique_ptr<WorkerQueue>(new WorkerQueue()));
+    for (unsigned int i = 0; i < workerCount; ++i)
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(m_wakeMutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (thread& worker : m_threads)
+        worker.join();
+}
+
+unsigned int ThreadPool::threadCount() const
+{
+    return static_cast<unsigned int>(m_threads.size()) + 1;
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const RangeTask& task)
+{
+    if (count == 0)
+        return;
+    grain = max<size_t>(grain, 1);
+    size_t rangeCount = (count + grain - 1) / grain;
+    if (m_threads.empty() || rangeCount == 1)
+    {
+        task(0, count);
+        return;
+    }
+
+    Loop loop;
+    loop.task = &task;
+    loop.remaining = rangeCount;
+
+    // The count is raised first so it never drops below the number of queued ranges
+    {
+        lock_guard<mutex> lock(m_wakeMutex);
+        m_queued += rangeCount;
+    }
+
+    // Consecutive ranges go to the same worker so each one starts on contiguous memory
+    size_t workers = m_queues.size();
+    size_t perWorker = (rangeCount + workers - 1) / workers;
+    for (size_t w = 0; w < workers; ++w)
+    {
+        size_t first = w * perWorker;
+        size_t last = min(rangeCount, first + perWorker);
+        if (first >= last)
+            break;
+        lock_guard<mutex> lock(m_queues[w]->mutex);
+        for (size_t r = last; r-- > first;)
+            m_queues[w]->ranges.push_back(Range{ &loop, r * grain, min(count, (r + 1) * grain) });
+    }
+    m_wake.notify_all();
+
+    // The calling thread steals ranges until there are none left, then waits for the last ones to finish
+    Range range;
+    while (loop.remaining.load() > 0 && steal(workers, range))
+        run(range);
+
+    unique_lock<mutex> lock(loop.doneMutex);
+    loop.done.wait(lock, [&loop] { return loop.remaining.load() == 0; });
+}
+
+ThreadPool& ThreadPool::shared()
+{
+    static ThreadPool pool(max(1u, thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+bool ThreadPool::popOwn(size_t worker, Range& range)
+{
+    WorkerQueue& queue = *m_queues[worker];
+    lock_guard<mutex> lock(queue.mutex);
+    if (queue.ranges.empty())
+        return false;
+    range = queue.ranges.back();
+    queue.ranges.pop_back();
+    --m_queued;
+    return true;
+}
+
+// The thief looks at the other queues starting after its own, the calling thread uses index workers
+bool ThreadPool::steal(size_t thief, Range& range)
+{
+    size_t workers = m_queues.size();
+    for (size_t i = 1; i <= workers; ++i)
+    {
+        WorkerQueue& queue = *m_queues[(thief + i) % workers];
+        lock_guard<mutex> lock(queue.mutex);
+        if (!queue.ranges.empty())
+        {
+            range = queue.ranges.front();
+            queue.ranges.pop_front();
+            --m_queued;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(const Range& range)
+{
+    Loop& loop = *range.loop;
+    (*loop.task)(range.begin, range.end);
+
+    // The count is decremented under the lock: the calling thread takes it before returning, so the loop
+    // cannot be destroyed while it is still used here
+    lock_guard<mutex> lock(loop.doneMutex);
+    if (--loop.remaining == 0)
+        loop.done.notify_all();
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+    setTraceThreadName("worker");
+    for (;;)
+    {
+        Range range;
+        if (popOwn(index, range) || steal(index, range))
+        {
+            run(range);
+            continue;
+        }
+
+        unique_lock<mutex> lock(m_wakeMutex);
+        m_wake.wait(lock, [this] { return m_stop || m_queued.load() > 0; });
+        if (m_stop)
+            return;
+    }
+}
@@ -0,0 +1,73 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: ThreadPool.h
+
+Description: Work-stealing thread pool. A parallel loop is split in ranges spread over the
+queues of the workers; each worker takes ranges from the back of its own queue and steals from
+the front of the others when it runs out, and the calling thread helps until the loop is done.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+    // Function called for each range [begin, end) of a parallel loop
+    typedef std::function<void(std::size_t begin, std::size_t end)> RangeTask;
+
+    // The pool starts workerCount threads, the calling thread of parallelFor works too
+    explicit ThreadPool(unsigned int workerCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads working on a parallel loop, including the calling thread
+    unsigned int threadCount() const;
+
+    // Function to run task over [0, count) in ranges of grain items, returns when every range is done.
+    // Each range is always the same whatever thread runs it, so the results do not depend on the scheduling
+    void parallelFor(std::size_t count, std::size_t grain, const RangeTask& task);
+
+    // Pool shared by the whole program, with one thread per core
+    static ThreadPool& shared();
+
+private:
+    struct Loop;
+
+    struct Range
+    {
+        Loop* loop;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    bool popOwn(std::size_t worker, Range& range);
+    bool steal(std::size_t thief, Range& range);
+    void run(const Range& range);
+    void workerLoop(std::size_t index);
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::atomic<std::size_t> m_queued;
+    bool m_stop;
+};
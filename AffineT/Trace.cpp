@@ -0,0 +1,227 @@
+#include "Trace.h"
+#include "SpscQueue.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+atomic<bool> trace_enabled(false);
+
+namespace
+{
+    typedef chrono::steady_clock Clock;
+
+    // Times are kept as clock ticks, the writer converts them to microseconds from the start of the trace
+    struct TraceEvent
+    {
+        const char* name;
+        int64_t start;
+        int64_t duration;
+    };
+
+    // Events a thread can record between two passes of the writer before they are dropped
+    const size_t threadQueueCapacity = 16384;
+
+    // Queue of the events of one thread. It is created on the first event of the thread and kept until
+    // the program ends, so the writer can read it without synchronizing with the thread
+    struct ThreadBuffer
+    {
+        SpscQueue<TraceEvent, threadQueueCapacity> events;
+        atomic<const char*> name;
+        atomic<size_t> dropped;
+        unsigned int threadId;
+    };
+
+    class TraceWriter
+    {
+    public:
+        TraceWriter() :
+            m_file(nullptr),
+            m_stop(false),
+            m_firstEvent(true)
+        {
+        }
+
+        ~TraceWriter()
+        {
+            stop();
+        }
+
+        bool start(const string& path, string& error);
+        size_t stop();
+
+        // Function to create the queue of the calling thread, the only time a traced thread takes a lock
+        ThreadBuffer* registerThread(const char* name);
+
+    private:
+        void writerLoop();
+
+        // Function to write the events queued by all the threads
+        void drain();
+
+        mutex m_mutex; // Guards the list of queues and the stop flag
+        condition_variable m_wake;
+        vector<unique_ptr<ThreadBuffer>> m_buffers;
+        thread m_writer;
+        FILE* m_file;
+        Clock::time_point m_origin;
+        bool m_stop;
+        bool m_firstEvent;
+    };
+
+    TraceWriter& traceWriter()
+    {
+        static TraceWriter writer;
+        return writer;
+    }
+
+    thread_local ThreadBuffer* thread_buffer = nullptr;
+    thread_local const char* thread_name = nullptr;
+}
+
+bool TraceWriter::start(const string& path, string& error)
+{
+    if (m_file)
+    {
+        error = "A trace is already being written";
+        return false;
+    }
+    m_file = fopen(path.c_str(), "w");
+    if (!m_file)
+    {
+        error = "Could not create the trace file " + path;
+        return false;
+    }
+    setvbuf(m_file, nullptr, _IOFBF, 1 << 16);
+    fprintf(m_file, "{\"traceEvents\":[\n");
+
+    // Events left from a previous trace are discarded
+    lock_guard<mutex> lock(m_mutex);
+    TraceEvent event;
+    for (const unique_ptr<ThreadBuffer>& buffer : m_buffers)
+    {
+        while (buffer->events.pop(event))
+        {
+        }
+        buffer->dropped.store(0);
+    }
+    m_origin = Clock::now();
+    m_stop = false;
+    m_firstEvent = true;
+    m_writer = thread(&TraceWriter::writerLoop, this);
+    trace_enabled.store(true);
+    return true;
+}
+
+size_t TraceWriter::stop()
+{
+    if (!m_file)
+        return 0;
+
+    trace_enabled.store(false);
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    m_writer.join();
+    drain();
+
+    // The names of the threads are metadata events, Perfetto shows them in place of the thread ids
+    size_t dropped = 0;
+    for (const unique_ptr<ThreadBuffer>& buffer : m_buffers)
+    {
+        const char* name = buffer->name.load();
+        if (name)
+        {
+            fprintf(m_file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    m_firstEvent ? "" : ",\n", buffer->threadId, name);
+            m_firstEvent = false;
+        }
+        dropped += buffer->dropped.exchange(0);
+    }
+    fprintf(m_file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(m_file);
+    m_file = nullptr;
+    return dropped;
+}
+
+ThreadBuffer* TraceWriter::registerThread(const char* name)
+{
+    unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+    buffer->name = name;
+    buffer->dropped = 0;
+
+    lock_guard<mutex> lock(m_mutex);
+    buffer->threadId = static_cast<unsigned int>(m_buffers.size()) + 1;
+    m_buffers.push_back(move(buffer));
+    return m_buffers.back().get();
+}
+
+void TraceWriter::writerLoop()
+{
+    unique_lock<mutex> lock(m_mutex);
+    while (!m_stop)
+    {
+        m_wake.wait_for(lock, chrono::milliseconds(10));
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+void TraceWriter::drain()
+{
+    // The queues are never removed, so the list can be copied and read without the lock
+    vector<ThreadBuffer*> buffers;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        for (const unique_ptr<ThreadBuffer>& buffer : m_buffers)
+            buffers.push_back(buffer.get());
+    }
+
+    TraceEvent event;
+    for (ThreadBuffer* buffer : buffers)
+    {
+        while (buffer->events.pop(event))
+        {
+            Clock::time_point start = Clock::time_point(Clock::duration(event.start));
+            double timestamp = chrono::duration<double, micro>(start - m_origin).count();
+            double duration = chrono::duration<double, micro>(Clock::duration(event.duration)).count();
+            fprintf(m_file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    m_firstEvent ? "" : ",\n", event.name, buffer->threadId, timestamp, duration);
+            m_firstEvent = false;
+        }
+    }
+}
+
+bool startTrace(const string& path, string& error)
+{
+    return traceWriter().start(path, error);
+}
+
+size_t stopTrace()
+{
+    return traceWriter().stop();
+}
+
+void setTraceThreadName(const char* name)
+{
+    thread_name = name;
+    if (thread_buffer)
+        thread_buffer->name.store(name);
+}
+
+void recordTraceZone(const char* name, Clock::time_point start, Clock::time_point end)
+{
+    if (!thread_buffer)
+        thread_buffer = traceWriter().registerThread(thread_name);
+
+    TraceEvent event = { name, start.time_since_epoch().count(), (end - start).count() };
+    if (!thread_buffer->events.push(event))
+        thread_buffer->dropped.fetch_add(1, memory_order_relaxed);
+}
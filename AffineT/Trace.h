@@ -0,0 +1,59 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: Trace.h
+
+Description: Trace of the hot paths written to a Chrome Trace Event JSON file, which opens in
+Perfetto (ui.perfetto.dev) or chrome://tracing. A TraceZone records the time from its creation to
+the end of its scope as one complete event of the thread it runs on.
+Each thread pushes its events to its own lock-free queue, and a writer thread drains the queues
+and formats the JSON in the background, so a traced thread never takes a lock, formats text or
+writes to the file. If a queue is full the event is dropped and counted rather than waiting.
+When no trace is started a zone only tests a flag.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+// Set while a trace is started
+extern std::atomic<bool> trace_enabled;
+
+// Function to start writing the trace to a file, returns false with a message if it cannot be created
+bool startTrace(const std::string& path, std::string& error);
+
+// Function to write the remaining events, close the file and return the number of dropped events
+std::size_t stopTrace();
+
+// Function to name the calling thread in the trace, the name must be a string literal
+void setTraceThreadName(const char* name);
+
+// Function to record a zone of the calling thread, the name must be a string literal
+void recordTraceZone(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+class TraceZone
+{
+public:
+    explicit TraceZone(const char* name) :
+        m_name(trace_enabled.load(std::memory_order_relaxed) ? name : nullptr)
+    {
+        if (m_name)
+            m_start = std::chrono::steady_clock::now();
+    }
+
+    ~TraceZone()
+    {
+        if (m_name)
+            recordTraceZone(m_name, m_start, std::chrono::steady_clock::now());
+    }
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+    const char* m_name;
+    std::chrono::steady_clock::time_point m_start;
+};
@@ -0,0 +1,225 @@
+#include "TransformKernel.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define AFFINET_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AFFINET_TARGET_AVX2
+#else
+#define AFFINET_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace std;
+
+namespace
+{
+    // Vertices per parallel chunk: 16k vertices are 128 KB of input and output, which stays in the L2 cache
+    const size_t parallelChunk = 16384;
+
+    // The same loop is the float fallback and the kernel of the other scalar types
+    template <typename T>
+    void transformScalar(const BasicAffineMatrix<T>& m, const float* xIn, const float* yIn, float* xOut, float* yOut, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            T x = static_cast<T>(xIn[i]);
+            T y = static_cast<T>(yIn[i]);
+            xOut[i] = static_cast<float>(m.a * x + m.b * y + m.tx);
+            yOut[i] = static_cast<float>(m.c * x + m.d * y + m.ty);
+        }
+    }
+
+    // Function to transform a chunk on the calling thread, the float matrices go through the best SIMD path
+    void transformChunk(KernelPath path, const AffineMatrix& matrix, const float* xIn, const float* yIn, float* xOut, float* yOut, size_t count)
+    {
+        transformVertices(path, matrix, xIn, yIn, xOut, yOut, count);
+    }
+
+    template <typename T>
+    void transformChunk(KernelPath, const BasicAffineMatrix<T>& matrix, const float* xIn, const float* yIn, float* xOut, float* yOut, size_t count)
+    {
+        transformScalar(matrix, xIn, yIn, xOut, yOut, count);
+    }
+
+#ifdef AFFINET_X86
+    void transformSSE2(const AffineMatrix& m, const float* xIn, const float* yIn, float* xOut, float* yOut, size_t count)
+    {
+        const __m128 a = _mm_set1_ps(m.a);
+        const __m128 b = _mm_set1_ps(m.b);
+        const __m128 c = _mm_set1_ps(m.c);
+        const __m128 d = _mm_set1_ps(m.d);
+        const __m128 tx = _mm_set1_ps(m.tx);
+        const __m128 ty = _mm_set1_ps(m.ty);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(xIn + i);
+            __m128 y = _mm_loadu_ps(yIn + i);
+            __m128 xNew = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, x), _mm_mul_ps(b, y)), tx);
+            __m128 yNew = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c, x), _mm_mul_ps(d, y)), ty);
+            _mm_storeu_ps(xOut + i, xNew);
+            _mm_storeu_ps(yOut + i, yNew);
+        }
+        transformScalar(m, xIn + i, yIn + i, xOut + i, yOut + i, count - i);
+    }
+
+    AFFINET_TARGET_AVX2
+    void transformAVX2(const AffineMatrix& m, const float* xIn, const float* yIn, float* xOut, float* yOut, size_t count)
+    {
+        const __m256 a = _mm256_set1_ps(m.a);
+        const __m256 b = _mm256_set1_ps(m.b);
+        const __m256 c = _mm256_set1_ps(m.c);
+        const __m256 d = _mm256_set1_ps(m.d);
+        const __m256 tx = _mm256_set1_ps(m.tx);
+        const __m256 ty = _mm256_set1_ps(m.ty);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 x = _mm256_loadu_ps(xIn + i);
+            __m256 y = _mm256_loadu_ps(yIn + i);
+            __m256 xNew = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, x), _mm256_mul_ps(b, y)), tx);
+            __m256 yNew = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(c, x), _mm256_mul_ps(d, y)), ty);
+            _mm256_storeu_ps(xOut + i, xNew);
+            _mm256_storeu_ps(yOut + i, yNew);
+        }
+        transformScalar(m, xIn + i, yIn + i, xOut + i, yOut + i, count - i);
+    }
+
+    bool detectSSE2()
+    {
+#if defined(_M_X64) || defined(__x86_64__)
+        return true; // SSE2 is part of the x64 baseline
+#elif defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[3] & (1 << 26)) != 0;
+#else
+        return __builtin_cpu_supports("sse2");
+#endif
+    }
+
+    bool detectAVX2()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        // The processor has to support AVX and the OS has to save the YMM registers
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    struct CpuFeatures
+    {
+        bool sse2 = false;
+        bool avx2 = false;
+
+        CpuFeatures()
+        {
+#ifdef AFFINET_X86
+            sse2 = detectSSE2();
+            avx2 = sse2 && detectAVX2();
+#endif
+        }
+    };
+
+    const CpuFeatures& cpuFeatures()
+    {
+        static const CpuFeatures features;
+        return features;
+    }
+}
+
+template <typename T>
+void transformVertices(const BasicAffineMatrix<T>& matrix, const float* xIn, const float* yIn, float* xOut, float* yOut, size_t count)
+{
+    KernelPath path = activeKernelPath();
+    ThreadPool& pool = ThreadPool::shared();
+    if (count < 2 * parallelChunk || pool.threadCount() == 1)
+    {
+        transformChunk(path, matrix, xIn, yIn, xOut, yOut, count);
+        return;
+    }
+
+    // Every vertex is independent, each chunk writes its own part of the output
+    pool.parallelFor(count, parallelChunk, [&](size_t begin, size_t end) {
+        TraceZone zone("transform range");
+        transformChunk(path, matrix, xIn + begin, yIn + begin, xOut + begin, yOut + begin, end - begin);
+    });
+}
+
+template void transformVertices(const BasicAffineMatrix<float>&, const float*, const float*, float*, float*, size_t);
+template void transformVertices(const BasicAffineMatrix<double>&, const float*, const float*, float*, float*, size_t);
+template void transformVertices(const BasicAffineMatrix<Fixed32>&, const float*, const float*, float*, float*, size_t);
+
+void transformVertices(KernelPath path, const AffineMatrix& matrix, const float* xIn, const float* yIn, float* xOut, float* yOut, size_t count)
+{
+    if (!isKernelPathSupported(path))
+        path = KernelPath::Scalar;
+
+    switch (path)
+    {
+#ifdef AFFINET_X86
+    case KernelPath::AVX2:
+        transformAVX2(matrix, xIn, yIn, xOut, yOut, count);
+        break;
+    case KernelPath::SSE2:
+        transformSSE2(matrix, xIn, yIn, xOut, yOut, count);
+        break;
+#endif
+    default:
+        transformScalar(matrix, xIn, yIn, xOut, yOut, count);
+        break;
+    }
+}
+
+KernelPath activeKernelPath()
+{
+    static const KernelPath path = isKernelPathSupported(KernelPath::AVX2) ? KernelPath::AVX2 :
+                                   isKernelPathSupported(KernelPath::SSE2) ? KernelPath::SSE2 :
+                                   KernelPath::Scalar;
+    return path;
+}
+
+bool isKernelPathSupported(KernelPath path)
+{
+    switch (path)
+    {
+    case KernelPath::AVX2:
+        return cpuFeatures().avx2;
+    case KernelPath::SSE2:
+        return cpuFeatures().sse2;
+    default:
+        return true;
+    }
+}
+
+const char* kernelPathName(KernelPath path)
+{
+    switch (path)
+    {
+    case KernelPath::AVX2:
+        return "AVX2";
+    case KernelPath::SSE2:
+        return "SSE2";
+    default:
+        return "scalar";
+    }
+}
@@ -0,0 +1,40 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: TransformKernel.h
+
+Description: Batch kernel applying an affine matrix to arrays of x and y coordinates. The kernel is
+a template on the scalar type of the matrix: with float matrices SSE2 and AVX2 versions are used
+when the processor supports them, with a scalar fallback chosen at runtime, and with double or
+fixed point matrices each coordinate is converted, transformed and rounded back to float. Large
+batches are spread over all the cores.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "AffineMatrix.h"
+#include <cstddef>
+
+enum class KernelPath
+{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Function to apply the matrix to count vertices in the precision of T. The output arrays may be the same as the
+// input arrays. Large batches are split in chunks over the shared thread pool. Instantiated for float, double
+// and Fixed32
+template <typename T>
+void transformVertices(const BasicAffineMatrix<T>& matrix, const float* xIn, const float* yIn, float* xOut, float* yOut, std::size_t count);
+
+// Same as transformVertices with a float matrix but always uses the given path on the calling thread, falling
+// back to scalar if the path is not supported
+void transformVertices(KernelPath path, const AffineMatrix& matrix, const float* xIn, const float* yIn, float* xOut, float* yOut, std::size_t count);
+
+// Best path supported by the processor, detected once on first use
+KernelPath activeKernelPath();
+
+bool isKernelPathSupported(KernelPath path);
+
+const char* kernelPathName(KernelPath path);
@@ -0,0 +1,115 @@
+#include "TransformPipeline.h"
+#include "RotationCache.h"
+#include "TransformKernel.h"
+#include "Trace.h"
+#include <utility>
+using namespace std;
+
+// Rotations come from the rotation table in double and from the fixed point sine and cosine in fixed point
+JournalMatrix commandMatrix(const TransformCommand& command)
+{
+    JournalScalar x = static_cast<JournalScalar>(command.x);
+    JournalScalar y = static_cast<JournalScalar>(command.y);
+    switch (command.type)
+    {
+    case TransformType::Translation:
+        return JournalMatrix::translation(x, y);
+    case TransformType::Scaling:
+        return JournalMatrix::scaling(x, y);
+    case TransformType::Rotation:
+        return rotationMatrix(x);
+    default:
+        return JournalMatrix::shearing(x, y);
+    }
+}
+
+TransformPipeline::TransformPipeline(VertexStore vertices) :
+    m_original(move(vertices)),
+    m_transformed(m_original),
+    m_journal(1, JournalEntry{ TransformCommand(), JournalMatrix() }),
+    m_step(0),
+    m_matrix(),
+    m_revision(0),
+    m_dirty(false)
+{
+}
+
+void TransformPipeline::append(const TransformCommand& command)
+{
+    JournalMatrix matrix = commandMatrix(command) * m_journal[m_step].matrix;
+    m_journal.resize(m_step + 1);
+    m_journal.push_back(JournalEntry{ command, matrix });
+    jumpTo(m_step + 1);
+}
+
+bool TransformPipeline::undo()
+{
+    return m_step > 0 && jumpTo(m_step - 1);
+}
+
+bool TransformPipeline::redo()
+{
+    return jumpTo(m_step + 1);
+}
+
+bool TransformPipeline::jumpTo(size_t step)
+{
+    if (step >= m_journal.size())
+    {
+        return false;
+    }
+    m_step = step;
+    m_matrix = m_journal[step].matrix.cast<Scalar>();
+    ++m_revision;
+    m_dirty = true;
+    return true;
+}
+
+size_t TransformPipeline::step() const
+{
+    return m_step;
+}
+
+size_t TransformPipeline::stepCount() const
+{
+    return m_journal.size() - 1;
+}
+
+const TransformCommand& TransformPipeline::command(size_t step) const
+{
+    return m_journal[step].command;
+}
+
+const VertexStore& TransformPipeline::original() const
+{
+    return m_original;
+}
+
+const ScalarMatrix& TransformPipeline::matrix() const
+{
+    return m_matrix;
+}
+
+const JournalMatrix& TransformPipeline::preciseMatrix() const
+{
+    return m_journal[m_step].matrix;
+}
+
+const VertexStore& TransformPipeline::vertices()
+{
+    if (m_dirty)
+    {
+        TraceZone zone("evaluate vertices");
+
+        // Every vertex is evaluated from the original one, so no matter how many transformations
+        // were appended each vertex goes through a single matrix multiplication
+        transformVertices(m_matrix, m_original.x(), m_original.y(), m_transformed.x(), m_transformed.y(), m_original.size());
+        m_dirty = false;
+    }
+    return m_transformed;
+}
+
+unsigned int TransformPipeline::revision() const
+{
+    return m_revision;
+}
@@ -0,0 +1,85 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: TransformPipeline.h
+
+Description: Keeps the vertices of a shape in Cartesian coordinates together with the composed
+matrix of every transformation applied so far. Each transformation only updates the matrix; the
+transformed vertices are evaluated lazily, once, the next time they are requested.
+The original vertices are never modified and the matrix is accumulated in double precision (in fixed
+point in the fixed point build, see Scalar.h), so the displayed shape does not drift however many
+transformations are applied: the only rounding is the conversion of the matrix to the scalar type of
+the build and the single multiplication per vertex.
+Every step is kept in a journal with its command and the composed matrix after it, so undoing,
+redoing or going back to any step only selects another matrix whatever the number of vertices, the
+vertices are evaluated again only for the step that is displayed, and the commands that lead to the
+current step can be read back to replay or verify them.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "AffineMatrix.h"
+#include "TransformScript.h"
+#include "VertexStore.h"
+#include <cstddef>
+#include <vector>
+
+// Function to get the matrix of a command in the precision of the journal, also used by the scene graph
+JournalMatrix commandMatrix(const TransformCommand& command);
+
+class TransformPipeline
+{
+public:
+    explicit TransformPipeline(VertexStore vertices);
+
+    // Append a transformation, it is applied after all the previous ones
+    // The steps that were undone are discarded
+    void append(const TransformCommand& command);
+
+    // Functions to move in the journal, they return false if there is no such step
+    bool undo();
+    bool redo();
+
+    // Go to the state after the given number of transformations, 0 being the original shape
+    bool jumpTo(std::size_t step);
+
+    // Number of transformations applied in the current state
+    std::size_t step() const;
+
+    // Number of transformations in the journal, including the ones that were undone
+    std::size_t stepCount() const;
+
+    // Command of a step of the journal, from 1 to stepCount
+    const TransformCommand& command(std::size_t step) const;
+
+    // Vertices before any transformation
+    const VertexStore& original() const;
+
+    // Composed matrix of all the transformations appended so far, converted to the scalar type of the build
+    const ScalarMatrix& matrix() const;
+
+    // Same matrix in the precision it is accumulated in
+    const JournalMatrix& preciseMatrix() const;
+
+    // Transformed vertices, evaluated only if the matrix changed since the last call
+    const VertexStore& vertices();
+
+    // Incremented every time the state changes, used to know when a shape needs to be updated
+    unsigned int revision() const;
+
+private:
+    VertexStore m_original;
+    VertexStore m_transformed;
+    // A step of the journal: the command and the composed matrix after it
+    struct JournalEntry
+    {
+        TransformCommand command;
+        JournalMatrix matrix;
+    };
+
+    std::vector<JournalEntry> m_journal; // The first entry is the original shape, with the identity and no command
+    std::size_t m_step;
+    ScalarMatrix m_matrix;
+    unsigned int m_revision;
+    bool m_dirty;
+};
@@ -0,0 +1,158 @@
+#include "TransformScript.h"
+#include "Trace.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+using namespace std;
+
+namespace
+{
+    // Number of values each command takes
+    int argumentCount(TransformType type)
+    {
+        return type == TransformType::Rotation ? 1 : 2;
+    }
+
+    bool parseTransformType(const string& name, TransformType& type)
+    {
+        if (name == "translate")
+            type = TransformType::Translation;
+        else if (name == "scale")
+            type = TransformType::Scaling;
+        else if (name == "rotate")
+            type = TransformType::Rotation;
+        else if (name == "shear")
+            type = TransformType::Shearing;
+        else
+            return false;
+        return true;
+    }
+
+    // Function to parse a "part n" line. Returns false with an error message if the part does not exist
+    bool parsePart(const string& line, size_t partCount, size_t& part, string& error)
+    {
+        istringstream stream(line);
+        string name;
+        string extra;
+        stream >> name;
+        if (!(stream >> part) || (stream >> extra))
+        {
+            error = "part expects the number of a part";
+            return false;
+        }
+        if (part > partCount)
+        {
+            error = "part " + to_string(part) + " does not exist, there are " + to_string(partCount) + " parts";
+            return false;
+        }
+        return true;
+    }
+
+    // Function to parse a command file, "part n" lines are only allowed when there are parts
+    bool loadScript(const string& path, size_t partCount, vector<PartCommand>& commands, string& error)
+    {
+        TraceZone zone("parse script");
+
+        ifstream file(path);
+        if (!file)
+        {
+            error = "Could not open " + path;
+            return false;
+        }
+
+        string line;
+        size_t lineNumber = 0;
+        size_t part = 0;
+        while (getline(file, line))
+        {
+            ++lineNumber;
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == string::npos || line[first] == '#')
+                continue;
+
+            string name;
+            string message;
+            istringstream(line) >> name;
+            if (partCount > 0 && name == "part")
+            {
+                if (!parsePart(line, partCount, part, message))
+                {
+                    error = path + ":" + to_string(lineNumber) + ": " + message;
+                    return false;
+                }
+                continue;
+            }
+
+            TransformCommand command;
+            if (!parseTransformCommand(line, command, message))
+            {
+                error = path + ":" + to_string(lineNumber) + ": " + message;
+                return false;
+            }
+            commands.push_back(PartCommand{ part, command });
+        }
+        return true;
+    }
+}
+
+const char* transformTypeName(TransformType type)
+{
+    switch (type)
+    {
+    case TransformType::Translation:
+        return "translate";
+    case TransformType::Scaling:
+        return "scale";
+    case TransformType::Rotation:
+        return "rotate";
+    default:
+        return "shear";
+    }
+}
+
+bool parseTransformCommand(const string& line, TransformCommand& command, string& error)
+{
+    istringstream stream(line);
+    string name;
+    if (!(stream >> name) || !parseTransformType(name, command.type))
+    {
+        error = "unknown command \"" + name + "\"";
+        return false;
+    }
+
+    float values[2] = { 0, 0 };
+    int count = argumentCount(command.type);
+    for (int i = 0; i < count; ++i)
+    {
+        if (!(stream >> values[i]) || !isfinite(values[i]))
+        {
+            error = name + " expects " + to_string(count) + (count == 1 ? " number" : " numbers");
+            return false;
+        }
+    }
+    string extra;
+    if (stream >> extra)
+    {
+        error = "unexpected \"" + extra + "\" after " + name;
+        return false;
+    }
+
+    command.x = values[0];
+    command.y = values[1];
+    return true;
+}
+
+bool loadTransformScript(const string& path, vector<TransformCommand>& commands, string& error)
+{
+    vector<PartCommand> partCommands;
+    if (!loadScript(path, 0, partCommands, error))
+        return false;
+    for (const PartCommand& partCommand : partCommands)
+        commands.push_back(partCommand.command);
+    return true;
+}
+
+bool loadAssemblyScript(const string& path, size_t partCount, vector<PartCommand>& commands, string& error)
+{
+    return loadScript(path, partCount, commands, error);
+}
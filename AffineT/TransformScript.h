@@ -0,0 +1,59 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: TransformScript.h
+
+Description: Transformation commands and the parser for command files used by the batch mode.
+Each line of a command file holds one command:
+
+    translate dx dy
+    scale sx sy
+    rotate angle        (degrees, counterclockwise)
+    shear shx shy
+
+Empty lines and lines starting with '#' are ignored. The command files of an assembly (several
+shapes) can also hold "part n" lines: the commands after one move the part n alone, in the order the
+shapes were given starting at 1, and "part 0" goes back to moving the whole assembly. All the commands
+apply in the order of the file, a part command acts after the whole assembly commands before it.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class TransformType
+{
+    Translation,
+    Scaling,
+    Rotation,
+    Shearing
+};
+
+// A single transformation, rotations only use x for the angle in degrees
+struct TransformCommand
+{
+    TransformType type;
+    float x;
+    float y;
+};
+
+// Name of a transformation in the command files
+const char* transformTypeName(TransformType type);
+
+// Function to parse one line of a command file. Returns false with an error message if the line is not a command
+bool parseTransformCommand(const std::string& line, TransformCommand& command, std::string& error);
+
+// A command of an assembly with the part it moves, 0 for the whole assembly
+struct PartCommand
+{
+    std::size_t part;
+    TransformCommand command;
+};
+
+// Function to parse a whole command file. Blank and comment lines are skipped
+bool loadTransformScript(const std::string& path, std::vector<TransformCommand>& commands, std::string& error);
+
+// Function to parse the command file of an assembly of partCount shapes, where "part n" lines are allowed
+bool loadAssemblyScript(const std::string& path, std::size_t partCount, std::vector<PartCommand>& commands, std::string& error);
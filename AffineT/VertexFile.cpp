@@ -0,0 +1,281 @@
+#include "VertexFile.h"
+#include "MappedFile.h"
+#include "Trace.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+using namespace std;
+
+namespace
+{
+    const char binaryMagic[8] = { 'A', 'F', 'F', 'I', 'N', 'E', 'T', 'V' };
+    const uint32_t binaryVersion = 1;
+    const size_t binaryAlignment = 64;
+
+    struct BinaryHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t scalarSize;
+        uint64_t count;
+        uint64_t xOffset;
+        uint64_t yOffset;
+        char reserved[24];
+    };
+
+    static_assert(sizeof(BinaryHeader) == 64, "The binary header must be 64 bytes");
+
+    bool hasExtension(const string& path, const string& extension)
+    {
+        return path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+    }
+
+    size_t alignUp(size_t value)
+    {
+        return (value + binaryAlignment - 1) / binaryAlignment * binaryAlignment;
+    }
+
+    bool isSeparator(char c)
+    {
+        return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r';
+    }
+
+    const char* skipSeparators(const char* p, const char* end)
+    {
+        while (p < end && isSeparator(*p))
+            ++p;
+        return p;
+    }
+
+    // Function to parse one coordinate, returns the position after it or nullptr if there is no number
+    const char* parseCoordinate(const char* p, const char* end, float& value)
+    {
+        p = skipSeparators(p, end);
+        if (p < end && *p == '+')
+            ++p;
+        from_chars_result result = from_chars(p, end, value);
+        if (result.ec != errc())
+            return nullptr;
+        return result.ptr;
+    }
+
+    bool loadText(const char* begin, const char* end, const string& path, VertexStore& vertices, string& error)
+    {
+        // First pass counts the vertices so the store is allocated only once
+        size_t count = 0;
+        for (const char* line = begin; line < end;)
+        {
+            const char* lineEnd = static_cast<const char*>(memchr(line, '\n', end - line));
+            if (!lineEnd)
+                lineEnd = end;
+            const char* first = skipSeparators(line, lineEnd);
+            if (first < lineEnd && *first != '#')
+                ++count;
+            line = lineEnd + 1;
+        }
+
+        VertexStore loaded(count);
+        size_t index = 0;
+        size_t lineNumber = 0;
+        for (const char* line = begin; line < end;)
+        {
+            const char* lineEnd = static_cast<const char*>(memchr(line, '\n', end - line));
+            if (!lineEnd)
+                lineEnd = end;
+            ++lineNumber;
+            float x, y;
+            bool isVertex;
+            if (!parseVertexLine(line, lineEnd, x, y, isVertex))
+            {
+                error = path + ":" + to_string(lineNumber) + ": expected two coordinates";
+                return false;
+            }
+            if (isVertex)
+            {
+                loaded.x()[index] = x;
+                loaded.y()[index] = y;
+                ++index;
+            }
+            line = lineEnd + 1;
+        }
+
+        vertices = move(loaded);
+        return true;
+    }
+
+    bool loadBinary(const shared_ptr<MappedFile>& file, const string& path, VertexStore& vertices, string& error)
+    {
+        BinaryHeader header;
+        memcpy(&header, file->data(), sizeof(header));
+
+        size_t size = file->size();
+        bool valid = header.version == binaryVersion &&
+                     (header.scalarSize == 4 || header.scalarSize == 8) &&
+                     header.xOffset >= sizeof(header) && header.yOffset >= sizeof(header) &&
+                     header.xOffset % header.scalarSize == 0 && header.yOffset % header.scalarSize == 0 &&
+                     header.xOffset <= size && header.yOffset <= size &&
+                     header.count <= (size - header.xOffset) / header.scalarSize &&
+                     header.count <= (size - header.yOffset) / header.scalarSize;
+        if (!valid)
+        {
+            error = path + ": invalid or unsupported binary vertex file";
+            return false;
+        }
+
+        size_t count = static_cast<size_t>(header.count);
+        char* x = file->data() + header.xOffset;
+        char* y = file->data() + header.yOffset;
+        if (header.scalarSize == 4)
+        {
+            // The mapping itself becomes the vertex store, it stays mapped as long as the store uses it
+            vertices = VertexStore(reinterpret_cast<float*>(x), reinterpret_cast<float*>(y), count, file);
+            return true;
+        }
+
+        VertexStore loaded(count);
+        const double* xIn = reinterpret_cast<const double*>(x);
+        const double* yIn = reinterpret_cast<const double*>(y);
+        for (size_t i = 0; i < count; ++i)
+        {
+            loaded.x()[i] = static_cast<float>(xIn[i]);
+            loaded.y()[i] = static_cast<float>(yIn[i]);
+        }
+        vertices = move(loaded);
+        return true;
+    }
+
+    bool saveBinary(const string& path, const VertexStore& vertices, string& error)
+    {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            error = "Could not open " + path + " for writing";
+            return false;
+        }
+
+        size_t bytes = vertices.size() * sizeof(float);
+        BinaryHeader header = {};
+        memcpy(header.magic, binaryMagic, sizeof(binaryMagic));
+        header.version = binaryVersion;
+        header.scalarSize = sizeof(float);
+        header.count = vertices.size();
+        header.xOffset = alignUp(sizeof(header));
+        header.yOffset = alignUp(header.xOffset + bytes);
+
+        const char padding[binaryAlignment] = {};
+        size_t xPadding = static_cast<size_t>(header.xOffset) - sizeof(header);
+        size_t yPadding = static_cast<size_t>(header.yOffset - header.xOffset) - bytes;
+        bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                       fwrite(padding, 1, xPadding, file) == xPadding &&
+                       fwrite(vertices.x(), 1, bytes, file) == bytes &&
+                       fwrite(padding, 1, yPadding, file) == yPadding &&
+                       fwrite(vertices.y(), 1, bytes, file) == bytes;
+        written = fclose(file) == 0 && written;
+        if (!written)
+        {
+            error = "Could not write " + path;
+            return false;
+        }
+        return true;
+    }
+
+    bool saveText(const string& path, const VertexStore& vertices, string& error)
+    {
+        FILE* file = path.empty() ? stdout : fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            error = "Could not open " + path + " for writing";
+            return false;
+        }
+
+        // The vertices are formatted into a block that is written at once instead of line by line
+        const size_t blockSize = 1 << 16;
+        string block;
+        block.resize(blockSize + maxVertexLineLength);
+        size_t used = 0;
+        bool written = true;
+        for (size_t i = 0; i < vertices.size() && written; ++i)
+        {
+            used = formatVertexLine(&block[used], vertices.x()[i], vertices.y()[i]) - block.data();
+            if (used >= blockSize)
+            {
+                written = fwrite(block.data(), 1, used, file) == used;
+                used = 0;
+            }
+        }
+        if (written && used > 0)
+            written = fwrite(block.data(), 1, used, file) == used;
+
+        if (file == stdout)
+            written = fflush(file) == 0 && written;
+        else
+            written = fclose(file) == 0 && written;
+
+        if (!written)
+        {
+            error = "Could not write " + (path.empty() ? string("the vertices") : path);
+            return false;
+        }
+        return true;
+    }
+}
+
+bool loadVertexFile(const string& path, VertexStore& vertices, string& error)
+{
+    TraceZone zone("parse vertices");
+
+    // Both formats are read straight from the mapped file, without reading it into a buffer first
+    shared_ptr<MappedFile> file = make_shared<MappedFile>();
+    if (!file->open(path, error))
+        return false;
+
+    VertexStore loaded;
+    bool isBinary = file->size() >= sizeof(BinaryHeader) && memcmp(file->data(), binaryMagic, sizeof(binaryMagic)) == 0;
+    bool valid = isBinary ? loadBinary(file, path, loaded, error) :
+                            loadText(file->data(), file->data() + file->size(), path, loaded, error);
+    if (!valid)
+        return false;
+
+    if (loaded.size() < 3)
+    {
+        error = path + " must hold at least 3 vertices";
+        return false;
+    }
+
+    vertices = move(loaded);
+    return true;
+}
+
+bool saveVertexFile(const string& path, const VertexStore& vertices, string& error)
+{
+    if (hasExtension(path, ".afv"))
+        return saveBinary(path, vertices, error);
+    return saveText(path, vertices, error);
+}
+
+bool parseVertexLine(const char* begin, const char* end, float& x, float& y, bool& isVertex)
+{
+    const char* p = skipSeparators(begin, end);
+    isVertex = p < end && *p != '#';
+    if (!isVertex)
+        return true;
+
+    p = parseCoordinate(p, end, x);
+    if (p)
+        p = parseCoordinate(p, end, y);
+    return p && skipSeparators(p, end) == end;
+}
+
+// Shortest text that reads back as the exact same float
+char* formatVertexLine(char* p, float x, float y)
+{
+    const size_t maxNumber = (maxVertexLineLength - 2) / 2;
+    p = to_chars(p, p + maxNumber, x).ptr;
+    *p++ = ' ';
+    p = to_chars(p, p + maxNumber, y).ptr;
+    *p++ = '\n';
+    return p;
+}
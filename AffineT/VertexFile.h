@@ -0,0 +1,46 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: VertexFile.h
+
+Description: Loading and saving of shape vertices. Two formats are supported:
+
+Text: each line holds the x and y coordinates of one vertex separated by spaces, tabs, commas or
+semicolons. Empty lines and lines starting with '#' are ignored.
+
+Binary (.afv): a 64 byte little-endian header followed by all the x coordinates and then all the
+y coordinates, each block starting on a 64 byte boundary so it can be used in place as the arrays
+of a VertexStore. Files are memory-mapped, and float32 files are used without any copy.
+
+    offset  size  field
+    0       8     magic "AFFINETV"
+    8       4     version (1)
+    12      4     scalar size in bytes (4 for float32, 8 for float64)
+    16      8     number of vertices
+    24      8     offset of the x block
+    32      8     offset of the y block
+    40      24    reserved, zero
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "VertexStore.h"
+#include <string>
+
+// Function to load the vertices of a shape from a file, the format is detected from the content.
+// On failure the error message is set and false is returned
+bool loadVertexFile(const std::string& path, VertexStore& vertices, std::string& error);
+
+// Function to write the vertices to a file, in the binary format if the path ends with ".afv" and as text
+// otherwise. An empty path writes the text to the standard output
+bool saveVertexFile(const std::string& path, const VertexStore& vertices, std::string& error);
+
+// Longest text formatVertexLine can write
+const std::size_t maxVertexLineLength = 64;
+
+// Function to parse one line of a text vertex file, without its end of line. Blank and comment lines are
+// valid but set isVertex to false. Returns false if the line is not valid
+bool parseVertexLine(const char* begin, const char* end, float& x, float& y, bool& isVertex);
+
+// Function to write a vertex as a line of text at p, returns the position after the end of line
+char* formatVertexLine(char* p, float x, float y);
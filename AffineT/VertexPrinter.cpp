@@ -0,0 +1,112 @@
+#include "VertexPrinter.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+using namespace std;
+
+namespace
+{
+    // Longest text a single number can take
+    const size_t maxNumberLength = 32;
+}
+
+bool parseVerbosity(const string& name, Verbosity& verbosity)
+{
+    if (name == "quiet")
+        verbosity = Verbosity::Quiet;
+    else if (name == "summary")
+        verbosity = Verbosity::Summary;
+    else if (name == "full")
+        verbosity = Verbosity::Full;
+    else
+        return false;
+    return true;
+}
+
+VertexPrinter::VertexPrinter(Verbosity verbosity, FILE* output) :
+    m_verbosity(verbosity),
+    m_output(output),
+    m_used(0)
+{
+}
+
+void VertexPrinter::setVerbosity(Verbosity verbosity)
+{
+    m_verbosity = verbosity;
+}
+
+Verbosity VertexPrinter::getVerbosity() const
+{
+    return m_verbosity;
+}
+
+void VertexPrinter::print(const VertexStore& vertices)
+{
+    if (m_verbosity == Verbosity::Quiet)
+        return;
+
+    // Reserve the worst case up front so the buffer grows at most once for a given number of vertices
+    size_t lines = m_verbosity == Verbosity::Full ? vertices.size() : 1;
+    m_buffer.resize(max(m_buffer.size(), (lines + 2) * (3 * maxNumberLength + 16)));
+    m_used = 0;
+
+    append("Shape Vertices:");
+    if (m_verbosity == Verbosity::Summary)
+    {
+        append(" ");
+        append(vertices.size());
+        if (!vertices.empty())
+        {
+            auto x = minmax_element(vertices.x(), vertices.x() + vertices.size());
+            auto y = minmax_element(vertices.y(), vertices.y() + vertices.size());
+            append(", bounds (");
+            append(*x.first);
+            append(", ");
+            append(*y.first);
+            append(") to (");
+            append(*x.second);
+            append(", ");
+            append(*y.second);
+            append(")");
+        }
+        append("\n");
+    }
+    else
+    {
+        append("\n");
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            append("Vertex ");
+            append(i + 1);
+            append(": (");
+            append(vertices.x()[i]);
+            append(", ");
+            append(vertices.y()[i]);
+            append(")\n");
+        }
+    }
+
+    fwrite(m_buffer.data(), 1, m_used, m_output);
+    fflush(m_output);
+}
+
+void VertexPrinter::append(const char* text)
+{
+    size_t length = strlen(text);
+    memcpy(&m_buffer[m_used], text, length);
+    m_used += length;
+}
+
+// Same text as cout with its default precision of 6 significant digits
+void VertexPrinter::append(float value)
+{
+    char* first = &m_buffer[m_used];
+    m_used = to_chars(first, first + maxNumberLength, value, chars_format::general, 6).ptr - m_buffer.data();
+}
+
+void VertexPrinter::append(size_t value)
+{
+    char* first = &m_buffer[m_used];
+    m_used = to_chars(first, first + maxNumberLength, value).ptr - m_buffer.data();
+}
@@ -0,0 +1,49 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: VertexPrinter.h
+
+Description: Printing of the shape vertices to the console. The text is formatted with
+std::to_chars (no locale, no stream state) into a buffer that is reused between calls, and
+written with a single write and a single flush instead of flushing every line.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "VertexStore.h"
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+enum class Verbosity
+{
+    Quiet,      // Nothing is printed
+    Summary,    // Number of vertices and bounding box
+    Full        // Every vertex
+};
+
+// Function to read a verbosity level from its name (quiet, summary or full)
+bool parseVerbosity(const std::string& name, Verbosity& verbosity);
+
+class VertexPrinter
+{
+public:
+    explicit VertexPrinter(Verbosity verbosity = Verbosity::Full, FILE* output = stdout);
+
+    void setVerbosity(Verbosity verbosity);
+    Verbosity getVerbosity() const;
+
+    // Function to print the vertices of a shape to the output, the standard output by default
+    void print(const VertexStore& vertices);
+
+private:
+    void append(const char* text);
+    void append(float value);
+    void append(std::size_t value);
+
+    Verbosity m_verbosity;
+    FILE* m_output;
+    std::vector<char> m_buffer;
+    std::size_t m_used;
+};
@@ -0,0 +1,190 @@
+#include "VertexStore.h"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+using namespace std;
+
+namespace
+{
+    // The capacity is rounded up so that the arrays always hold a whole number of SIMD registers
+    const size_t paddingFloats = 16;
+
+    float* allocateAligned(size_t count)
+    {
+        if (count == 0)
+            return nullptr;
+        void* memory;
+#ifdef _MSC_VER
+        memory = _aligned_malloc(count * sizeof(float), VertexStore::alignment);
+#else
+        if (posix_memalign(&memory, VertexStore::alignment, count * sizeof(float)) != 0)
+            memory = nullptr;
+#endif
+        if (!memory)
+            throw bad_alloc();
+        return static_cast<float*>(memory);
+    }
+
+    void freeAligned(float* memory)
+    {
+#ifdef _MSC_VER
+        _aligned_free(memory);
+#else
+        free(memory);
+#endif
+    }
+}
+
+VertexStore::VertexStore() :
+    m_x(nullptr),
+    m_y(nullptr),
+    m_size(0),
+    m_capacity(0)
+{
+}
+
+VertexStore::VertexStore(size_t count) :
+    VertexStore()
+{
+    resize(count);
+}
+
+VertexStore::VertexStore(const vector<sf::Vector2f>& vertices) :
+    VertexStore(vertices.size())
+{
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        m_x[i] = vertices[i].x;
+        m_y[i] = vertices[i].y;
+    }
+}
+
+VertexStore::VertexStore(float* x, float* y, size_t count, shared_ptr<void> owner) :
+    m_x(x),
+    m_y(y),
+    m_size(count),
+    m_capacity(count),
+    m_owner(move(owner))
+{
+}
+
+VertexStore::VertexStore(const VertexStore& other) :
+    VertexStore(other.m_size)
+{
+    copy(other.m_x, other.m_x + m_size, m_x);
+    copy(other.m_y, other.m_y + m_size, m_y);
+}
+
+VertexStore::VertexStore(VertexStore&& other) noexcept :
+    m_x(other.m_x),
+    m_y(other.m_y),
+    m_size(other.m_size),
+    m_capacity(other.m_capacity),
+    m_owner(move(other.m_owner))
+{
+    other.m_x = nullptr;
+    other.m_y = nullptr;
+    other.m_size = 0;
+    other.m_capacity = 0;
+}
+
+VertexStore& VertexStore::operator=(VertexStore other) noexcept
+{
+    swap(m_x, other.m_x);
+    swap(m_y, other.m_y);
+    swap(m_size, other.m_size);
+    swap(m_capacity, other.m_capacity);
+    swap(m_owner, other.m_owner);
+    return *this;
+}
+
+VertexStore::~VertexStore()
+{
+    if (!m_owner)
+    {
+        freeAligned(m_x);
+        freeAligned(m_y);
+    }
+}
+
+void VertexStore::resize(size_t count)
+{
+    if (count > m_capacity)
+    {
+        size_t capacity = (count + paddingFloats - 1) / paddingFloats * paddingFloats;
+        float* x = allocateAligned(capacity);
+        float* y;
+        try
+        {
+            y = allocateAligned(capacity);
+        }
+        catch (...)
+        {
+            freeAligned(x);
+            throw;
+        }
+        copy(m_x, m_x + m_size, x);
+        copy(m_y, m_y + m_size, y);
+        if (!m_owner)
+        {
+            freeAligned(m_x);
+            freeAligned(m_y);
+        }
+        m_owner.reset();
+        m_x = x;
+        m_y = y;
+        m_capacity = capacity;
+    }
+    if (count > m_size)
+    {
+        fill(m_x + m_size, m_x + count, 0.0f);
+        fill(m_y + m_size, m_y + count, 0.0f);
+    }
+    m_size = count;
+}
+
+bool VertexStore::isExternal() const
+{
+    return m_owner != nullptr;
+}
+
+size_t VertexStore::size() const
+{
+    return m_size;
+}
+
+bool VertexStore::empty() const
+{
+    return m_size == 0;
+}
+
+float* VertexStore::x()
+{
+    return m_x;
+}
+
+float* VertexStore::y()
+{
+    return m_y;
+}
+
+const float* VertexStore::x() const
+{
+    return m_x;
+}
+
+const float* VertexStore::y() const
+{
+    return m_y;
+}
+
+sf::Vector2f VertexStore::point(size_t index) const
+{
+    return sf::Vector2f(m_x[index], m_y[index]);
+}
+
+void VertexStore::setPoint(size_t index, const sf::Vector2f& point)
+{
+    m_x[index] = point.x;
+    m_y[index] = point.y;
+}
@@ -0,0 +1,60 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: VertexStore.h
+
+Description: Structure-of-arrays container for the vertices of a shape. The x and y coordinates
+are kept in two separate contiguous arrays aligned for SIMD loads, so a whole batch of vertices
+can be transformed at once instead of point by point.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class VertexStore
+{
+public:
+    // Alignment of the coordinate arrays in bytes, enough for AVX loads and a full cache line
+    static const std::size_t alignment = 64;
+
+    VertexStore();
+    explicit VertexStore(std::size_t count);
+    explicit VertexStore(const std::vector<sf::Vector2f>& vertices);
+
+    // Use arrays owned by someone else, such as a mapped file, without copying them. The owner is kept
+    // alive as long as the arrays are used, and growing the store moves the vertices to its own memory
+    VertexStore(float* x, float* y, std::size_t count, std::shared_ptr<void> owner);
+
+    VertexStore(const VertexStore& other);
+    VertexStore(VertexStore&& other) noexcept;
+    VertexStore& operator=(VertexStore other) noexcept;
+    ~VertexStore();
+
+    // Change the number of vertices, the new vertices are set to (0, 0)
+    void resize(std::size_t count);
+
+    // True if the arrays belong to an external owner
+    bool isExternal() const;
+
+    std::size_t size() const;
+    bool empty() const;
+
+    float* x();
+    float* y();
+    const float* x() const;
+    const float* y() const;
+
+    sf::Vector2f point(std::size_t index) const;
+    void setPoint(std::size_t index, const sf::Vector2f& point);
+
+private:
+    float* m_x;
+    float* m_y;
+    std::size_t m_size;
+    std::size_t m_capacity;
+    std::shared_ptr<void> m_owner;
+};
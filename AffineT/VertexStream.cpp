@@ -0,0 +1,259 @@
+#include "VertexStream.h"
+#include "TransformKernel.h"
+#include "Trace.h"
+#include "VertexFile.h"
+#include "VertexStore.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+namespace
+{
+    // Number of chunks in flight: one being read, one being transformed and one being written
+    const int chunkCount = 3;
+
+    // Bytes read from the input at a time
+    const size_t readBlockSize = 1 << 20;
+
+    // Marks the end of the stream in the queues
+    const int endOfStream = -1;
+
+    struct Chunk
+    {
+        VertexStore vertices;
+        size_t count = 0;
+        vector<char> text;
+    };
+
+    // Blocking queue of chunk indices passed between the stages
+    class ChunkQueue
+    {
+    public:
+        void push(int index)
+        {
+            {
+                lock_guard<mutex> lock(m_mutex);
+                m_indices.push_back(index);
+            }
+            m_condition.notify_one();
+        }
+
+        int pop()
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return !m_indices.empty(); });
+            int index = m_indices.front();
+            m_indices.pop_front();
+            return index;
+        }
+
+    private:
+        mutex m_mutex;
+        condition_variable m_condition;
+        deque<int> m_indices;
+    };
+
+    // Reads whole lines from a file through a fixed buffer, a line cut by the end of the buffer is
+    // moved to the front before reading more
+    class LineReader
+    {
+    public:
+        explicit LineReader(FILE* file) :
+            m_file(file),
+            m_buffer(readBlockSize),
+            m_begin(0),
+            m_end(0),
+            m_eof(false),
+            m_failed(false)
+        {
+        }
+
+        // Function to get the next line without its end of line. Returns false at the end of the input
+        bool next(const char*& begin, const char*& end)
+        {
+            for (;;)
+            {
+                const char* data = m_buffer.data();
+                const char* newline = static_cast<const char*>(memchr(data + m_begin, '\n', m_end - m_begin));
+                if (newline)
+                {
+                    begin = data + m_begin;
+                    end = newline;
+                    m_begin = newline - data + 1;
+                    return true;
+                }
+                if (m_eof)
+                {
+                    // The last line may not end with a newline
+                    if (m_begin == m_end)
+                        return false;
+                    begin = data + m_begin;
+                    end = data + m_end;
+                    m_begin = m_end;
+                    return true;
+                }
+                refill();
+            }
+        }
+
+        bool failed() const
+        {
+            return m_failed;
+        }
+
+    private:
+        void refill()
+        {
+            size_t remaining = m_end - m_begin;
+            memmove(m_buffer.data(), m_buffer.data() + m_begin, remaining);
+            m_begin = 0;
+            m_end = remaining;
+            if (m_end == m_buffer.size())
+                m_buffer.resize(m_buffer.size() * 2); // A single line longer than the buffer
+            size_t read = fread(m_buffer.data() + m_end, 1, m_buffer.size() - m_end, m_file);
+            m_end += read;
+            if (read == 0)
+            {
+                m_eof = true;
+                m_failed = ferror(m_file) != 0;
+            }
+        }
+
+        FILE* m_file;
+        vector<char> m_buffer;
+        size_t m_begin;
+        size_t m_end;
+        bool m_eof;
+        bool m_failed;
+    };
+}
+
+bool streamVertices(FILE* input, FILE* output, const ScalarMatrix& matrix, size_t chunkVertices,
+                    StreamStats& stats, string& error)
+{
+    if (chunkVertices == 0)
+        chunkVertices = defaultStreamChunk;
+
+    Chunk chunks[chunkCount];
+    for (Chunk& chunk : chunks)
+    {
+        chunk.vertices.resize(chunkVertices);
+        chunk.text.resize(chunkVertices * maxVertexLineLength);
+    }
+
+    ChunkQueue freeChunks;
+    ChunkQueue readChunks;
+    ChunkQueue transformedChunks;
+    for (int i = 0; i < chunkCount; ++i)
+        freeChunks.push(i);
+
+    string readError;
+    bool writeFailed = false;
+
+    // Set by the writer when the output fails, the other stages then only drain the chunks in flight
+    atomic<bool> stopped(false);
+
+    // Reader: parses lines into free chunks until the input ends, a line is invalid or the output failed
+    thread reader([&] {
+        setTraceThreadName("stream reader");
+        LineReader lines(input);
+        size_t lineNumber = 0;
+        bool more = true;
+        while (more && !stopped.load())
+        {
+            int index = freeChunks.pop();
+            TraceZone zone("parse chunk");
+            Chunk& chunk = chunks[index];
+            chunk.count = 0;
+            const char* begin;
+            const char* end;
+            while (chunk.count < chunkVertices && (more = lines.next(begin, end)))
+            {
+                ++lineNumber;
+                float x, y;
+                bool isVertex;
+                if (!parseVertexLine(begin, end, x, y, isVertex))
+                {
+                    readError = "line " + to_string(lineNumber) + ": expected two coordinates";
+                    more = false;
+                    break;
+                }
+                if (isVertex)
+                {
+                    chunk.vertices.x()[chunk.count] = x;
+                    chunk.vertices.y()[chunk.count] = y;
+                    ++chunk.count;
+                }
+            }
+            if (lines.failed())
+                readError = "Could not read the input";
+            if (chunk.count > 0)
+                readChunks.push(index);
+        }
+        readChunks.push(endOfStream);
+    });
+
+    // Writer: formats each transformed chunk and writes it with a single call
+    thread writer([&] {
+        setTraceThreadName("stream writer");
+        for (;;)
+        {
+            int index = transformedChunks.pop();
+            if (index == endOfStream)
+                break;
+            Chunk& chunk = chunks[index];
+            if (!writeFailed)
+            {
+                TraceZone zone("write chunk");
+                char* p = chunk.text.data();
+                for (size_t i = 0; i < chunk.count; ++i)
+                    p = formatVertexLine(p, chunk.vertices.x()[i], chunk.vertices.y()[i]);
+                size_t bytes = p - chunk.text.data();
+                writeFailed = fwrite(chunk.text.data(), 1, bytes, output) != bytes;
+                if (writeFailed)
+                    stopped = true;
+            }
+            freeChunks.push(index);
+        }
+    });
+
+    // The calling thread transforms the chunks in place
+    for (;;)
+    {
+        int index = readChunks.pop();
+        if (index == endOfStream)
+            break;
+        Chunk& chunk = chunks[index];
+        if (stopped.load())
+        {
+            transformedChunks.push(index);
+            continue;
+        }
+        TraceZone zone("transform chunk");
+        transformVertices(matrix, chunk.vertices.x(), chunk.vertices.y(), chunk.vertices.x(), chunk.vertices.y(), chunk.count);
+        stats.vertices += chunk.count;
+        ++stats.chunks;
+        transformedChunks.push(index);
+    }
+    transformedChunks.push(endOfStream);
+    writer.join();
+    reader.join();
+
+    writeFailed = fflush(output) != 0 || writeFailed;
+    if (!readError.empty())
+    {
+        error = readError;
+        return false;
+    }
+    if (writeFailed)
+    {
+        error = "Could not write the output";
+        return false;
+    }
+    return true;
+}
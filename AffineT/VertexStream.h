@@ -0,0 +1,33 @@
+/* ----------------------------------------------------------------------------------------------
+
+File: VertexStream.h
+
+Description: Streaming transformation of text vertices that do not have to fit in memory. The
+input is read in fixed size chunks, each chunk is transformed with the composed matrix and
+written out before its buffer is reused. Reading, transforming and writing run on their own
+threads over a small ring of chunks, so the three stages overlap and memory stays bounded.
+When the output fails the reading stops at the next chunk, so a full disk or a closed pipe does
+not make the whole input be parsed for nothing.
+
+-----------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "AffineMatrix.h"
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+struct StreamStats
+{
+    std::size_t vertices = 0;
+    std::size_t chunks = 0;
+};
+
+// Default number of vertices per chunk
+const std::size_t defaultStreamChunk = 1 << 16;
+
+// Function to transform the text vertices read from input and write them to output, in the text vertex
+// file format. On failure the error message is set and false is returned
+bool streamVertices(std::FILE* input, std::FILE* output, const ScalarMatrix& matrix, std::size_t chunkVertices,
+                    StreamStats& stats, std::string& error);